@@ -77,6 +77,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoilextbomodules.hh
              opm/models/blackoil/blackoilproperties.hh
              opm/models/blackoil/blackoilprimaryvariables.hh
+             opm/models/blackoil/blackoilsequentialsolver.hh
              opm/models/blackoil/blackoilproblem.hh
              opm/models/blackoil/blackoilenergymodules.hh
              opm/models/blackoil/blackoiltwophaseindices.hh
@@ -125,6 +126,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbasegradientcalculator.hh
              opm/models/discretization/common/fvbaseproblem.hh
              opm/models/discretization/common/fvbaseprimaryvariables.hh
+             opm/models/discretization/common/timestepcontrollers.hh
              opm/models/discretization/common/linearizationtype.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
@@ -157,6 +159,8 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/io/cubegridvanguard.hh
              opm/models/io/baseoutputwriter.hh
              opm/models/io/vtkmultiwriter.hh
+             opm/models/io/vtuwriter.hh
+             opm/models/io/xdmfwriter.hh
              opm/models/io/vtkmultiphasemodule.hh
              opm/models/io/vtkdiscretefracturemodule.hh
              opm/models/io/vtkdiffusionmodule.hh
@@ -212,17 +216,22 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/richards/richardsintensivequantities.hh
              opm/models/richards/richardslocalresidual.hh
              opm/models/utils/start.hh
+             opm/models/utils/benchmark.hh
              opm/models/utils/timerguard.hh
              opm/models/utils/propertysystem.hh
              opm/models/utils/propertysystemmacros.hh
              opm/models/utils/pffgridvector.hh
+             opm/models/utils/cuthillmckee.hh
              opm/models/utils/prefetch.hh
              opm/models/utils/parametersystem.hh
              opm/models/utils/simulator.hh
              opm/models/utils/quadraturegeometries.hh
              opm/models/utils/alignedallocator.hh
              opm/models/utils/timer.hh
+             opm/models/utils/profiler.hh
              opm/models/utils/signum.hh
+             opm/models/utils/tabulatedsegmenthint.hh
+             opm/models/utils/regiontablearena.hh
              opm/models/utils/genericguard.hh
              opm/models/utils/basicproperties.hh
              opm/simulators/linalg/parallelistlbackend.hh
@@ -15,6 +15,7 @@ set (opm-models_CONFIG_VAR
   HAVE_DUNE_FEM
   HAVE_ECL_INPUT
   HAVE_ECL_OUTPUT
+  HAVE_ZLIB
   DUNE_AVOID_CAPABILITIES_IS_PARALLEL_DEPRECATION_WARNING
   )
 
@@ -38,6 +39,8 @@ set (opm-models_DEPS
   "Valgrind"
   # quadruple precision floating point calculations
   "Quadmath"
+  # compression of the native VTU output
+  "ZLIB"
   )
 
 find_package_deps(opm-models)
@@ -35,6 +35,8 @@
 #include "blackoildiffusionmodule.hh"
 #include <opm/models/common/multiphasebaseextensivequantities.hh>
 
+#include <type_traits>
+
 namespace Opm {
 
 /*!
@@ -62,9 +64,22 @@ class BlackOilExtensiveQuantities
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
 
+    enum { enableSolvent = getPropValue<TypeTag, Properties::EnableSolvent>() };
+    enum { enablePolymer = getPropValue<TypeTag, Properties::EnablePolymer>() };
+    enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
     enum { enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>() };
     using DiffusionExtensiveQuantities = BlackOilDiffusionExtensiveQuantities<TypeTag, enableDiffusion>;
 
+    // the extensions which are disabled must not increase the size of the objects
+    static_assert(enableSolvent || std::is_empty<BlackOilSolventExtensiveQuantities<TypeTag>>::value,
+                  "The extensive quantities of the disabled solvent extension must be empty");
+    static_assert(enablePolymer || std::is_empty<BlackOilPolymerExtensiveQuantities<TypeTag>>::value,
+                  "The extensive quantities of the disabled polymer extension must be empty");
+    static_assert(enableEnergy || std::is_empty<BlackOilEnergyExtensiveQuantities<TypeTag>>::value,
+                  "The extensive quantities of the disabled energy extension must be empty");
+    static_assert(enableDiffusion || std::is_empty<DiffusionExtensiveQuantities>::value,
+                  "The extensive quantities of the disabled diffusion extension must be empty");
+
 
 public:
     /*!
@@ -79,10 +94,15 @@ public:
     {
         MultiPhaseParent::update(elemCtx, scvfIdx, timeIdx);
 
-        asImp_().updateSolvent(elemCtx, scvfIdx, timeIdx);
-        asImp_().updatePolymer(elemCtx, scvfIdx, timeIdx);
-        asImp_().updateEnergy(elemCtx, scvfIdx, timeIdx);
-        DiffusionExtensiveQuantities::update_(elemCtx, scvfIdx, timeIdx);
+        // the extensions which are disabled at compile time do not contribute any code
+        if constexpr (enableSolvent)
+            asImp_().updateSolvent(elemCtx, scvfIdx, timeIdx);
+        if constexpr (enablePolymer)
+            asImp_().updatePolymer(elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableEnergy)
+            asImp_().updateEnergy(elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableDiffusion)
+            DiffusionExtensiveQuantities::update_(elemCtx, scvfIdx, timeIdx);
     }
 
     template <class Context, class FluidState>
@@ -93,7 +113,8 @@ public:
     {
         MultiPhaseParent::updateBoundary(ctx, bfIdx, timeIdx, fluidState);
 
-        asImp_().updateEnergyBoundary(ctx, bfIdx, timeIdx, fluidState);
+        if constexpr (enableEnergy)
+            asImp_().updateEnergyBoundary(ctx, bfIdx, timeIdx, fluidState);
     }
 
 protected:
@@ -31,6 +31,7 @@
 #include "blackoilproperties.hh"
 //#include <opm/models/io/vtkblackoilfoammodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/tabulatedsegmenthint.hh>
 
 #include <opm/material/common/Tabulated1DFunction.hpp>
 //#include <opm/material/common/IntervalTabulated2DFunction.hpp>
@@ -470,6 +471,18 @@ std::vector<typename BlackOilFoamModule<TypeTag, enableFoam>::TabulatedFunction>
 BlackOilFoamModule<TypeTag, enableFoam>::gasMobilityMultiplierTable_;
 
 
+/*!
+ * \ingroup BlackOil
+ *
+ * \brief The segments of the tables of the foam extension which were used by the last
+ *        update of the intensive quantities of a degree of freedom.
+ */
+struct BlackOilFoamTableHints
+{
+    TabulatedSegmentHint gasMobilityMultiplier;
+    TabulatedSegmentHint adsorbedFoam;
+};
+
 /*!
  * \ingroup BlackOil
  * \class Opm::BlackOilFoamIntensiveQuantities
@@ -513,6 +526,13 @@ public:
         foamConcentration_ = priVars.makeEvaluation(foamConcentrationIdx, timeIdx);
         const auto& fs = asImp_().fluidState_;
 
+        // start the table lookups at the segments which were used by the last update
+        // of the degree of freedom. the hints are only available to the element which
+        // owns the degree of freedom; the other ones start at the last segments used by
+        // their element context.
+        if (const auto* tableHints = elemCtx.model().tableHints(elemCtx, dofIdx, timeIdx))
+            foamTableHints_ = tableHints->foam;
+
         // Compute gas mobility reduction factor
         Evaluation mobilityReductionFactor = 1.0;
         if (false) {
@@ -552,7 +572,7 @@ public:
             // Note that the current implementation only includes the effect of foam concentration (FOAMMOB),
             // and not the optional pressure dependence (FOAMMOBP) or shear dependence (FOAMMOBS).
             const auto& gasMobilityMultiplier = FoamModule::gasMobilityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            mobilityReductionFactor = gasMobilityMultiplier.eval(foamConcentration_, /* extrapolate = */ true);
+            mobilityReductionFactor = foamTableHints_.gasMobilityMultiplier.eval(gasMobilityMultiplier, foamConcentration_, /* extrapolate = */ true);
         }
 
         // adjust gas mobility
@@ -561,7 +581,12 @@ public:
         foamRockDensity_ = FoamModule::foamRockDensity(elemCtx, dofIdx, timeIdx);
 
         const auto& adsorbedFoamTable = FoamModule::adsorbedFoamTable(elemCtx, dofIdx, timeIdx);
-        foamAdsorbed_ = adsorbedFoamTable.eval(foamConcentration_, /*extrapolate=*/true);
+        foamAdsorbed_ = foamTableHints_.adsorbedFoam.eval(adsorbedFoamTable, foamConcentration_, /*extrapolate=*/true);
+
+        // keep the segments for the next update of the degree of freedom
+        if (auto* tableHints = elemCtx.model().tableHints(elemCtx, dofIdx, timeIdx))
+            tableHints->foam = foamTableHints_;
+
         if (!FoamModule::foamAllowDesorption(elemCtx, dofIdx, timeIdx)) {
             throw std::runtime_error("Foam module does not support the 'no desorption' option.");
         }
@@ -583,6 +608,9 @@ protected:
     Evaluation foamConcentration_;
     Scalar foamRockDensity_;
     Evaluation foamAdsorbed_;
+
+    // the segments of the tables which were used by the last lookups
+    BlackOilFoamTableHints foamTableHints_;
 };
 
 template <class TypeTag>
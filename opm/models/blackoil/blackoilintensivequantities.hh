@@ -41,6 +41,7 @@
 #include <dune/common/fmatrix.hh>
 
 #include <cstring>
+#include <type_traits>
 #include <utility>
 
 namespace Opm {
@@ -105,6 +106,22 @@ class BlackOilIntensiveQuantities
     using FluidState = BlackOilFluidState<Evaluation, FluidSystem, enableTemperature, enableEnergy, compositionSwitchEnabled,  enableBrine, Indices::numPhases >;
     using DiffusionIntensiveQuantities = BlackOilDiffusionIntensiveQuantities<TypeTag, enableDiffusion>;
 
+    // the extensions which are disabled must not increase the size of the objects
+    static_assert(enableSolvent || std::is_empty<BlackOilSolventIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled solvent extension must be empty");
+    static_assert(enableExtbo || std::is_empty<BlackOilExtboIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled extended black-oil extension must be empty");
+    static_assert(enablePolymer || std::is_empty<BlackOilPolymerIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled polymer extension must be empty");
+    static_assert(enableFoam || std::is_empty<BlackOilFoamIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled foam extension must be empty");
+    static_assert(enableBrine || std::is_empty<BlackOilBrineIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled brine extension must be empty");
+    static_assert(enableEnergy || std::is_empty<BlackOilEnergyIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled energy extension must be empty");
+    static_assert(enableDiffusion || std::is_empty<DiffusionIntensiveQuantities>::value,
+                  "The intensive quantities of the disabled diffusion extension must be empty");
+
 public:
     BlackOilIntensiveQuantities()
     {
@@ -134,7 +151,8 @@ public:
         unsigned pvtRegionIdx = priVars.pvtRegionIndex();
         fluidState_.setPvtRegionIndex(pvtRegionIdx);
 
-        asImp_().updateSaltConcentration_(elemCtx, dofIdx, timeIdx);
+        if constexpr (enableBrine)
+            asImp_().updateSaltConcentration_(elemCtx, dofIdx, timeIdx);
 
         // extract the water and the gas saturations for convenience
         Evaluation Sw = 0.0;
@@ -186,7 +204,8 @@ public:
         if (FluidSystem::phaseIsActive(oilPhaseIdx))
             fluidState_.setSaturation(oilPhaseIdx, So);
 
-        asImp_().solventPreSatFuncUpdate_(elemCtx, dofIdx, timeIdx);
+        if constexpr (enableSolvent)
+            asImp_().solventPreSatFuncUpdate_(elemCtx, dofIdx, timeIdx);
 
         // now we compute all phase pressures
         Evaluation pC[numPhases];
@@ -214,10 +233,12 @@ public:
         Valgrind::CheckDefined(mobility_);
 
         // update the Saturation functions for the blackoil solvent module.
-        asImp_().solventPostSatFuncUpdate_(elemCtx, dofIdx, timeIdx);
+        if constexpr (enableSolvent)
+            asImp_().solventPostSatFuncUpdate_(elemCtx, dofIdx, timeIdx);
 
         // update extBO parameters
-        asImp_().zFractionUpdate_(elemCtx, dofIdx, timeIdx);
+        if constexpr (enableExtbo)
+            asImp_().zFractionUpdate_(elemCtx, dofIdx, timeIdx);
 
         Evaluation SoMax = 0.0;
         if (FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx)) {
@@ -379,18 +400,25 @@ public:
         // deal with water induced rock compaction
         porosity_ *= problem.template rockCompPoroMultiplier<Evaluation>(*this, globalSpaceIdx);
 
-        asImp_().solventPvtUpdate_(elemCtx, dofIdx, timeIdx);
-        asImp_().zPvtUpdate_();
-        asImp_().polymerPropertiesUpdate_(elemCtx, dofIdx, timeIdx);
-        asImp_().updateEnergyQuantities_(elemCtx, dofIdx, timeIdx, paramCache);
-        asImp_().foamPropertiesUpdate_(elemCtx, dofIdx, timeIdx);
+        // the extensions which are disabled at compile time do not contribute any code
+        if constexpr (enableSolvent)
+            asImp_().solventPvtUpdate_(elemCtx, dofIdx, timeIdx);
+        if constexpr (enableExtbo)
+            asImp_().zPvtUpdate_();
+        if constexpr (enablePolymer)
+            asImp_().polymerPropertiesUpdate_(elemCtx, dofIdx, timeIdx);
+        if constexpr (enableEnergy)
+            asImp_().updateEnergyQuantities_(elemCtx, dofIdx, timeIdx, paramCache);
+        if constexpr (enableFoam)
+            asImp_().foamPropertiesUpdate_(elemCtx, dofIdx, timeIdx);
 
         // update the quantities which are required by the chosen
         // velocity model
         FluxIntensiveQuantities::update_(elemCtx, dofIdx, timeIdx);
 
         // update the diffusion specific quantities of the intensive quantities
-        DiffusionIntensiveQuantities::update_(fluidState_, paramCache, elemCtx, dofIdx, timeIdx);
+        if constexpr (enableDiffusion)
+            DiffusionIntensiveQuantities::update_(fluidState_, paramCache, elemCtx, dofIdx, timeIdx);
 
 #ifndef NDEBUG
         // some safety checks in debug mode
@@ -57,8 +57,11 @@
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 #include <opm/material/common/Unused.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -192,6 +195,19 @@ public:
 template<class TypeTag>
 struct BlackoilConserveSurfaceVolume<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
 
+//! by default, the region tables of the black-oil extensions are stored using the
+//! Scalar type and they are shared by all threads
+template<class TypeTag>
+struct RegionTablesUseFloat<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
+template<class TypeTag>
+struct RegionTablesFloatTolerance<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-6;
+};
+template<class TypeTag>
+struct ReplicateRegionTables<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -288,7 +304,23 @@ class BlackOilModel
     using EnergyModule = BlackOilEnergyModule<TypeTag>;
     using DiffusionModule = BlackOilDiffusionModule<TypeTag, enableDiffusion>;
 
+    struct NoTableHints_ {};
+
 public:
+    /*!
+     * \brief The segments of the tables of the black-oil extensions which were used by
+     *        the last update of the intensive quantities of a degree of freedom.
+     */
+    struct TableHints
+    {
+        std::conditional_t<getPropValue<TypeTag, Properties::EnableSolvent>(),
+                           BlackOilSolventTableHints, NoTableHints_> solvent;
+        std::conditional_t<getPropValue<TypeTag, Properties::EnablePolymer>(),
+                           BlackOilPolymerTableHints, NoTableHints_> polymer;
+        std::conditional_t<getPropValue<TypeTag, Properties::EnableFoam>(),
+                           BlackOilFoamTableHints, NoTableHints_> foam;
+    };
+
     BlackOilModel(Simulator& simulator)
         : ParentType(simulator)
     {}
@@ -306,6 +338,16 @@ public:
         EnergyModule::registerParameters();
         DiffusionModule::registerParameters();
 
+        EWOMS_REGISTER_PARAM(TypeTag, bool, RegionTablesUseFloat,
+                             "Store the sampling points of the region tables of the black-oil "
+                             "extensions using single precision where this is accurate enough");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, RegionTablesFloatTolerance,
+                             "The maximum relative error of a sampling point of a region table "
+                             "which is stored using single precision");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, ReplicateRegionTables,
+                             "Use a separate copy of the region tables of the black-oil "
+                             "extensions for each NUMA domain");
+
         // register runtime parameters of the VTK output modules
         VtkBlackOilModule<TypeTag>::registerParameters();
         VtkCompositionModule<TypeTag>::registerParameters();
@@ -320,6 +362,43 @@ public:
     static std::string name()
     { return "blackoil"; }
 
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit
+     */
+    void finishInit()
+    {
+        ParentType::finishInit();
+
+        tableHints_.clear();
+        tableHints_.resize(this->numGridDof());
+    }
+
+    /*!
+     * \brief Returns the segments of the tables which were used by the last update of
+     *        the intensive quantities of a degree of freedom.
+     *
+     * The hints are only kept for the most recent time index and can only be
+     * accessed by the element which owns the degree of freedom (cf.
+     * FvBaseDiscretization::dofOwner()), so no two threads access the same hints. For
+     * all other element contexts, nullptr is returned.
+     *
+     * \param elemCtx The element context which updates the intensive quantities
+     * \param dofIdx The local index of the degree of freedom in the element context
+     * \param timeIdx The index used by the time discretization
+     */
+    TableHints* tableHints(const ElementContext& elemCtx, unsigned dofIdx, unsigned timeIdx) const
+    {
+        if (timeIdx != 0)
+            return nullptr;
+
+        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+        if (globalIdx >= tableHints_.size()
+            || this->dofOwner(globalIdx) != this->elementMapper().index(elemCtx.element()))
+            return nullptr;
+
+        return &tableHints_[globalIdx];
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::primaryVarName
      */
@@ -467,6 +546,46 @@ public:
         return 1.0;
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::solutionPredictorSupported
+     */
+    bool solutionPredictorSupported() const
+    { return true; }
+
+    /*!
+     * \copydoc FvBaseDiscretization::extrapolatePrimaryVariables
+     *
+     * The switching primary variables are not extrapolated if their meaning changed
+     * between the two time steps and the extrapolated saturations are kept within
+     * their physical range.
+     */
+    void extrapolatePrimaryVariables(PrimaryVariables& result,
+                                     const PrimaryVariables& curPv,
+                                     const PrimaryVariables& oldPv,
+                                     Scalar factor) const
+    {
+        if (curPv.primaryVarsMeaning() != oldPv.primaryVarsMeaning()) {
+            result = curPv;
+            return;
+        }
+
+        ParentType::extrapolatePrimaryVariables(result, curPv, oldPv, factor);
+
+        if constexpr (waterEnabled) {
+            Scalar& Sw = result[Indices::waterSaturationIdx];
+            Sw = std::clamp(Sw, Scalar(0.0), Scalar(1.0));
+        }
+
+        if constexpr (compositionSwitchEnabled) {
+            Scalar& x = result[Indices::compositionSwitchIdx];
+            if (result.primaryVarsMeaning() == PrimaryVariables::Sw_po_Sg)
+                x = std::clamp(x, Scalar(0.0), Scalar(1.0));
+            else
+                // dissolution factors must not become negative
+                x = std::max(x, Scalar(0.0));
+        }
+    }
+
     /*!
      * \brief Write the current solution for a degree of freedom to a
      *        restart file.
@@ -618,6 +737,8 @@ private:
         unsigned regionIdx = context.problem().pvtRegionIndex(context, dofIdx, timeIdx);
         priVars.setPvtRegionIndex(regionIdx);
     }
+
+    mutable std::vector<TableHints> tableHints_;
 };
 } // namespace Opm
 
@@ -29,12 +29,16 @@
 #define EWOMS_BLACK_OIL_NEWTON_METHOD_HH
 
 #include "blackoilproperties.hh"
+#include "blackoilsequentialsolver.hh"
 
+#include <opm/models/discretization/common/linearizationtype.hh>
 #include <opm/models/utils/signum.hh>
 #include <opm/models/nonlinear/newtonmethod.hh>
 
 #include <opm/material/common/Unused.hpp>
 
+#include <stdexcept>
+
 namespace Opm::Properties {
 
 template <class TypeTag, class MyTypeTag>
@@ -54,6 +58,8 @@ template<class TypeTag, class MyTypeTag>
 struct TemperatureMax { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct TemperatureMin { using type = UndefinedProperty; };
+template<class TypeTag, class MyTypeTag>
+struct EnableSequentialImplicit { using type = UndefinedProperty; };
 template<class TypeTag>
 struct DpMaxRel<TypeTag, TTag::NewtonMethod>
 {
@@ -92,6 +98,8 @@ struct TemperatureMin<TypeTag, TTag::NewtonMethod>
     using type = GetPropType<TypeTag, Scalar>;
     static constexpr type value = 280; //Kelvin
 };
+template<class TypeTag>
+struct EnableSequentialImplicit<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -100,6 +108,14 @@ namespace Opm {
  * \ingroup BlackOilModel
  *
  * \brief A newton solver which is specific to the black oil model.
+ *
+ * Besides the fully implicit scheme, the sequential implicit scheme can be used:
+ * Then, the Newton iterations alternate between a pressure stage, which only updates
+ * the pressure, and a transport stage, which keeps it fixed. The iterations continue
+ * until the residual of the fully implicit system is converged, i.e., an outer
+ * iteration of the sequential scheme spans two Newton iterations. The stage of the
+ * current iteration is indicated by the linearization type of the linearizer. (see
+ * BlackOilSequentialSolver)
  */
 template <class TypeTag>
 class BlackOilNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonMethod>
@@ -113,11 +129,14 @@ class BlackOilNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonM
     using Indices = GetPropType<TypeTag, Properties::Indices>;
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
 
     static const unsigned numEq = getPropValue<TypeTag, Properties::NumEq>();
 
 public:
-    BlackOilNewtonMethod(Simulator& simulator) : ParentType(simulator)
+    BlackOilNewtonMethod(Simulator& simulator)
+        : ParentType(simulator)
+        , sequentialSolver_(simulator)
     {
         priVarOscilationThreshold_ = EWOMS_GET_PARAM(TypeTag, Scalar, PriVarOscilationThreshold);
         dpMaxRel_ = EWOMS_GET_PARAM(TypeTag, Scalar, DpMaxRel);
@@ -126,7 +145,12 @@ public:
         maxTempChange_ = EWOMS_GET_PARAM(TypeTag, Scalar, MaxTemperatureChange);
         tempMax_ = EWOMS_GET_PARAM(TypeTag, Scalar, TemperatureMax);
         tempMin_ = EWOMS_GET_PARAM(TypeTag, Scalar, TemperatureMin);
+        enableSequentialImplicit_ = EWOMS_GET_PARAM(TypeTag, bool, EnableSequentialImplicit);
 
+        // the pressure system is solved by a sequential AMG
+        if (enableSequentialImplicit_ && simulator.gridView().comm().size() > 1)
+            throw std::runtime_error("The sequential implicit scheme is not supported for "
+                                     "parallel runs");
     }
 
     /*!
@@ -155,6 +179,10 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MaxTemperatureChange, "Maximum absolute change of temperature in a single iteration");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, TemperatureMax, "Maximum absolute temperature");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, TemperatureMin, "Minimum absolute temperature");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableSequentialImplicit,
+                             "Alternate between solving for the pressure and for the "
+                             "remaining primary variables instead of solving the fully "
+                             "implicit system");
     }
 
     /*!
@@ -168,6 +196,17 @@ protected:
     friend NewtonMethod<TypeTag>;
     friend ParentType;
 
+    /*!
+     * \copydoc NewtonMethod::begin_
+     */
+    void begin_(const SolutionVector& u)
+    {
+        ParentType::begin_(u);
+
+        if (enableSequentialImplicit_)
+            sequentialSolver_.beginTimeStep();
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::beginIteration_
      */
@@ -175,6 +214,74 @@ protected:
     {
         numPriVarsSwitched_ = 0;
         ParentType::beginIteration_();
+
+        if (enableSequentialImplicit_) {
+            // the iterations of a time step start with the pressure stage
+            LinearizationType linearizationType = this->model().linearizer().getLinearizationType();
+            linearizationType.type =
+                (this->numIterations() % 2 == 0)
+                ? LinearizationType::pressure
+                : LinearizationType::seqtransport;
+            this->model().linearizer().setLinearizationType(linearizationType);
+        }
+    }
+
+    /*!
+     * \copydoc NewtonMethod::solveLinearSystem_
+     */
+    bool solveLinearSystem_(const SparseMatrixAdapter& jacobian,
+                            const GlobalEqVector& currentResidual,
+                            GlobalEqVector& solutionUpdate)
+    {
+        // the equations of the auxiliary modules cannot be split into stages
+        if (!enableSequentialImplicit_ || this->model().numAuxiliaryModules() > 0)
+            return ParentType::solveLinearSystem_(jacobian, currentResidual, solutionUpdate);
+
+        // the weights of the pressure stage are reused by the subsequent transport stage
+        const auto& linearizationType = this->model().linearizer().getLinearizationType();
+        if (linearizationType.type == LinearizationType::pressure) {
+            this->endIterMsg() << ", stage: pressure";
+            sequentialSolver_.updateWeights(jacobian);
+            return sequentialSolver_.solvePressure(jacobian,
+                                                   currentResidual,
+                                                   solutionUpdate,
+                                                   this->linearSolver_.linearSolverTolerance());
+        }
+
+        this->endIterMsg() << ", stage: transport";
+        sequentialSolver_.assembleTransport(jacobian, currentResidual);
+        this->linearSolver_.setResidual(sequentialSolver_.transportResidual());
+        this->linearSolver_.setMatrix(sequentialSolver_.transportMatrix());
+        solutionUpdate = 0.0;
+        return this->linearSolver_.solve(solutionUpdate);
+    }
+
+    /*!
+     * \copydoc NewtonMethod::end_
+     */
+    void end_()
+    {
+        resetLinearizationType_();
+        ParentType::end_();
+    }
+
+    /*!
+     * \copydoc NewtonMethod::failed_
+     */
+    void failed_()
+    {
+        resetLinearizationType_();
+        ParentType::failed_();
+    }
+
+    void resetLinearizationType_()
+    {
+        if (!enableSequentialImplicit_)
+            return;
+
+        LinearizationType linearizationType = this->model().linearizer().getLinearizationType();
+        linearizationType.type = LinearizationType::implicit;
+        this->model().linearizer().setLinearizationType(linearizationType);
     }
 
     /*!
@@ -183,18 +290,8 @@ protected:
     void endIteration_(SolutionVector& uCurrentIter,
                        const SolutionVector& uLastIter)
     {
-#if HAVE_MPI
-        // in the MPI enabled case we need to add up the number of DOF
-        // for which the interpretation changed over all processes.
-        int localSwitched = numPriVarsSwitched_;
-        MPI_Allreduce(&localSwitched,
-                      &numPriVarsSwitched_,
-                      /*num=*/1,
-                      MPI_INT,
-                      MPI_SUM,
-                      MPI_COMM_WORLD);
-#endif // HAVE_MPI
-
+        // the number of switched DOFs has already been summed up over all processes
+        // by update_()
         this->simulator_.model().newtonMethod().endIterMsg()
             << ", num switched=" << numPriVarsSwitched_;
 
@@ -209,25 +306,33 @@ public:
     {
         const auto& comm = this->simulator_.gridView().comm();
 
-        int succeeded;
+        // the update may be re-applied by the line search, so only the switches of the
+        // most recent update are counted
+        numPriVarsSwitched_ = 0;
+
+        int failed;
         try {
             ParentType::update_(nextSolution,
                                 currentSolution,
                                 solutionUpdate,
                                 currentResidual);
-            succeeded = 1;
+            failed = 0;
         }
         catch (...) {
             std::cout << "Newton update threw an exception on rank "
                       << comm.rank() << "\n";
-            succeeded = 0;
+            failed = 1;
         }
-        succeeded = comm.min(succeeded);
 
-        if (!succeeded)
+        // add up the number of failed processes and the number of DOFs for which the
+        // interpretation of the primary variables changed using a single reduction
+        int values[2] = { failed, numPriVarsSwitched_ };
+        comm.sum(values, 2);
+
+        if (values[0] > 0)
             throw NumericalIssue("A process did not succeed in adapting the primary variables");
 
-        numPriVarsSwitched_ = comm.sum(numPriVarsSwitched_);
+        numPriVarsSwitched_ = values[1];
     }
 
 protected:
@@ -399,6 +504,10 @@ private:
     Scalar maxTempChange_;
     Scalar tempMax_;
     Scalar tempMin_;
+    bool enableSequentialImplicit_;
+
+    // sets up the linear systems of the sequential implicit scheme
+    BlackOilSequentialSolver<TypeTag> sequentialSolver_;
 
     // keep track of cells where the primary variable meaning has changed
     // to detect and hinder oscillations
@@ -31,6 +31,8 @@
 #include "blackoilproperties.hh"
 #include <opm/models/io/vtkblackoilpolymermodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/regiontablearena.hh>
+#include <opm/models/utils/tabulatedsegmenthint.hh>
 
 #include <opm/material/common/Tabulated1DFunction.hpp>
 #include <opm/material/common/IntervalTabulated2DFunction.hpp>
@@ -74,10 +76,12 @@ class BlackOilPolymerModule
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using RateVector = GetPropType<TypeTag, Properties::RateVector>;
     using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Toolbox = MathToolbox<Evaluation>;
 
     using TabulatedFunction = Tabulated1DFunction<Scalar>;
+    using CompactTabulatedFunction = CompactTabulated1DFunction<Scalar>;
     using TabulatedTwoDFunction = IntervalTabulated2DFunction<Scalar>;
 
     static constexpr unsigned polymerConcentrationIdx = Indices::polymerConcentrationIdx;
@@ -361,6 +365,8 @@ public:
                 skprpolyTables_[tableNumber] = std::move(tablefunc);
             }
         }
+
+        setTableStorage_();
     }
 #endif
 
@@ -377,6 +383,7 @@ public:
         plyrockAdsorbtionIndex_.resize(numRegions);
         plyrockMaxAdsorbtion_.resize(numRegions);
         plyadsAdsorbedPolymer_.resize(numRegions);
+        tableArena_().invalidate();
     }
 
     /*!
@@ -406,6 +413,7 @@ public:
     static void setNumPvtRegions(unsigned numRegions)
     {
         plyviscViscosityMultiplierTable_.resize(numRegions);
+        tableArena_().invalidate();
     }
 
     /*!
@@ -417,6 +425,7 @@ public:
                            const TabulatedFunction& plyviscViscosityMultiplierTable)
     {
         plyviscViscosityMultiplierTable_[satRegionIdx] = plyviscViscosityMultiplierTable;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -764,6 +773,38 @@ public:
         return plyrockMaxAdsorbtion_[satnumRegionIdx];
     }
 
+    //! The region tables of the module, cf. evalRegionTable()
+    enum RegionTableGroup {
+        plyadsGroup,
+        plyviscGroup,
+        numRegionTableGroups
+    };
+
+    /*!
+     * \brief Evaluate a region table of the module at a given position.
+     *
+     * If the region tables are stored in single precision or replicated for each NUMA
+     * domain, the copy packed by the table arena is used. Otherwise, the table is
+     * accessed directly, i.e., the same as by the accessor of the table.
+     */
+    template <class LhsEval>
+    static LhsEval evalRegionTable(TabulatedSegmentHint& hint,
+                                   RegionTableGroup groupIdx,
+                                   const ElementContext& elemCtx,
+                                   unsigned scvIdx,
+                                   unsigned timeIdx,
+                                   const LhsEval& x)
+    {
+        unsigned regionIdx =
+            (groupIdx == plyviscGroup)
+            ? elemCtx.problem().pvtRegionIndex(elemCtx, scvIdx, timeIdx)
+            : elemCtx.problem().satnumRegionIndex(elemCtx, scvIdx, timeIdx);
+        if (useTableArena_)
+            return hint.eval(regionTable_(groupIdx, regionIdx), x, /*extrapolate=*/true);
+
+        return hint.eval((*tableGroups_[groupIdx])[regionIdx], x, /*extrapolate=*/true);
+    }
+
     static const TabulatedFunction& plyadsAdsorbedPolymer(const ElementContext& elemCtx,
                                                           unsigned scvIdx,
                                                           unsigned timeIdx)
@@ -837,8 +878,10 @@ public:
     {
         using ToolboxLocal = MathToolbox<Evaluation>;
 
-        const auto& viscosityMultiplierTable = plyviscViscosityMultiplierTable_[pvtnumRegionIdx];
-        Scalar viscosityMultiplier = viscosityMultiplierTable.eval(scalarValue(polymerConcentration), /*extrapolate=*/true);
+        Scalar viscosityMultiplier =
+            useTableArena_
+            ? regionTable_(plyviscGroup, pvtnumRegionIdx).eval(scalarValue(polymerConcentration), /*extrapolate=*/true)
+            : plyviscViscosityMultiplierTable_[pvtnumRegionIdx].eval(scalarValue(polymerConcentration), /*extrapolate=*/true);
 
         const Scalar eps = 1e-14;
         // return 1.0 if the polymer has no effect on the water.
@@ -910,6 +953,31 @@ public:
     }
 
 private:
+    static void setTableStorage_()
+    {
+        unsigned numReplicas = 1;
+        if (EWOMS_GET_PARAM(TypeTag, bool, ReplicateRegionTables))
+            numReplicas = ThreadManager::numNumaDomains();
+
+        bool useFloat = EWOMS_GET_PARAM(TypeTag, bool, RegionTablesUseFloat);
+        tableArena_().setStorage(useFloat,
+                                 EWOMS_GET_PARAM(TypeTag, Scalar, RegionTablesFloatTolerance),
+                                 numReplicas);
+
+        // with the default storage, the packed tables would be plain copies
+        useTableArena_ = useFloat || numReplicas > 1;
+    }
+
+    static const CompactTabulatedFunction& regionTable_(unsigned groupIdx, unsigned regionIdx)
+    { return tableArena_().table(groupIdx, regionIdx, ThreadManager::numaDomain()); }
+
+    static RegionTableArena<Scalar>& tableArena_()
+    {
+        static RegionTableArena<Scalar> arena(std::vector<const std::vector<TabulatedFunction>*>(
+                                                  std::begin(tableGroups_), std::end(tableGroups_)));
+        return arena;
+    }
+
     static std::vector<Scalar> plyrockDeadPoreVolume_;
     static std::vector<Scalar> plyrockResidualResistanceFactor_;
     static std::vector<Scalar> plyrockRockDensityFactor_;
@@ -917,6 +985,11 @@ private:
     static std::vector<Scalar> plyrockMaxAdsorbtion_;
     static std::vector<TabulatedFunction> plyadsAdsorbedPolymer_;
     static std::vector<TabulatedFunction> plyviscViscosityMultiplierTable_;
+
+    // the tables of each region table group and whether they are evaluated using the
+    // table arena
+    static const std::vector<TabulatedFunction>* const tableGroups_[numRegionTableGroups];
+    static bool useTableArena_;
     static std::vector<Scalar> plymaxMaxConcentration_;
     static std::vector<Scalar> plymixparToddLongstaff_;
     static std::vector<std::vector<Scalar>> plyshlogShearEffectRefMultiplier_;
@@ -1006,6 +1079,30 @@ template <class TypeTag, bool enablePolymerV>
 std::map<int, typename BlackOilPolymerModule<TypeTag, enablePolymerV>::SkprpolyTable>
 BlackOilPolymerModule<TypeTag, enablePolymerV>::skprpolyTables_;
 
+// the order must be the one of the region table groups
+template <class TypeTag, bool enablePolymerV>
+const std::vector<typename BlackOilPolymerModule<TypeTag, enablePolymerV>::TabulatedFunction>* const
+BlackOilPolymerModule<TypeTag, enablePolymerV>::tableGroups_[] = {
+    &plyadsAdsorbedPolymer_, &plyviscViscosityMultiplierTable_
+};
+
+template <class TypeTag, bool enablePolymerV>
+bool
+BlackOilPolymerModule<TypeTag, enablePolymerV>::useTableArena_ = false;
+
+/*!
+ * \ingroup BlackOil
+ *
+ * \brief The segments of the tables of the polymer extension which were used by the last
+ *        update of the intensive quantities of a degree of freedom.
+ */
+struct BlackOilPolymerTableHints
+{
+    TabulatedSegmentHint plyads;
+    TabulatedSegmentHint plyvisc;
+    TabulatedSegmentHint plyviscMax;
+};
+
 /*!
  * \ingroup BlackOil
  * \class Opm::BlackOilPolymerIntensiveQuantities
@@ -1054,10 +1151,16 @@ public:
         }
         const Scalar cmax = PolymerModule::plymaxMaxConcentration(elemCtx, dofIdx, timeIdx);
 
+        // start the table lookups at the segments which were used by the last update
+        // of the degree of freedom. the hints are only available to the element which
+        // owns the degree of freedom; the other ones start at the last segments used by
+        // their element context.
+        if (const auto* tableHints = elemCtx.model().tableHints(elemCtx, dofIdx, timeIdx))
+            polymerTableHints_ = tableHints->polymer;
+
         // permeability reduction due to polymer
         const Scalar& maxAdsorbtion = PolymerModule::plyrockMaxAdsorbtion(elemCtx, dofIdx, timeIdx);
-        const auto& plyadsAdsorbedPolymer = PolymerModule::plyadsAdsorbedPolymer(elemCtx, dofIdx, timeIdx);
-        polymerAdsorption_ = plyadsAdsorbedPolymer.eval(polymerConcentration_, /*extrapolate=*/true);
+        polymerAdsorption_ = PolymerModule::evalRegionTable(polymerTableHints_.plyads, PolymerModule::plyadsGroup, elemCtx, dofIdx, timeIdx, polymerConcentration_);
         if (PolymerModule::plyrockAdsorbtionIndex(elemCtx, dofIdx, timeIdx) == PolymerModule::NoDesorption) {
             const Scalar& maxPolymerAdsorption = elemCtx.problem().maxPolymerAdsorption(elemCtx, dofIdx, timeIdx);
             polymerAdsorption_ = std::max(Evaluation(maxPolymerAdsorption) , polymerAdsorption_);
@@ -1071,12 +1174,11 @@ public:
         if (!enablePolymerMolarWeight) {
             const auto& fs = asImp_().fluidState_;
             const Evaluation& muWater = fs.viscosity(waterPhaseIdx);
-            const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityMixture = viscosityMultiplier.eval(polymerConcentration_, /*extrapolate=*/true) * muWater;
+            const Evaluation viscosityMixture = PolymerModule::evalRegionTable(polymerTableHints_.plyvisc, PolymerModule::plyviscGroup, elemCtx, dofIdx, timeIdx, polymerConcentration_) * muWater;
 
             // Do the Todd-Longstaff mixing
             const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityPolymer = viscosityMultiplier.eval(cmax, /*extrapolate=*/true) * muWater;
+            const Evaluation viscosityPolymer = PolymerModule::evalRegionTable(polymerTableHints_.plyviscMax, PolymerModule::plyviscGroup, elemCtx, dofIdx, timeIdx, cmax) * muWater;
             const Evaluation viscosityPolymerEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(viscosityPolymer, 1.0 - plymixparToddLongstaff);
             const Evaluation viscosityWaterEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(muWater, 1.0 - plymixparToddLongstaff);
 
@@ -1107,6 +1209,10 @@ public:
         // update rock properties
         polymerDeadPoreVolume_ = PolymerModule::plyrockDeadPoreVolume(elemCtx, dofIdx, timeIdx);
         polymerRockDensity_ = PolymerModule::plyrockRockDensityFactor(elemCtx, dofIdx, timeIdx);
+
+        // keep the segments for the next update of the degree of freedom
+        if (auto* tableHints = elemCtx.model().tableHints(elemCtx, dofIdx, timeIdx))
+            tableHints->polymer = polymerTableHints_;
     }
 
     const Evaluation& polymerConcentration() const
@@ -1151,6 +1257,8 @@ protected:
     Evaluation polymerViscosityCorrection_;
     Evaluation waterViscosityCorrection_;
 
+    // the segments of the tables which were used by the last lookups
+    BlackOilPolymerTableHints polymerTableHints_;
 
 };
 
@@ -75,6 +75,21 @@ struct EnableTemperature { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct BlackOilEnergyScalingFactor { using type = UndefinedProperty; };
 
+//! Store the sampling points of the region tables of the black-oil extensions using
+//! single precision if this is accurate enough
+template<class TypeTag, class MyTypeTag>
+struct RegionTablesUseFloat { using type = UndefinedProperty; };
+
+//! The maximum relative error of a sampling point of a region table which is stored
+//! using single precision
+template<class TypeTag, class MyTypeTag>
+struct RegionTablesFloatTolerance { using type = UndefinedProperty; };
+
+//! Use a separate copy of the region tables of the black-oil extensions for each NUMA
+//! domain
+template<class TypeTag, class MyTypeTag>
+struct ReplicateRegionTables { using type = UndefinedProperty; };
+
 
 } // namespace Opm::Properties
 
@@ -0,0 +1,328 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilSequentialSolver
+ */
+#ifndef EWOMS_BLACK_OIL_SEQUENTIAL_SOLVER_HH
+#define EWOMS_BLACK_OIL_SEQUENTIAL_SOLVER_HH
+
+#include "blackoilproperties.hh"
+
+#include <opm/simulators/linalg/linalgproperties.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <cmath>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief Sets up and solves the linear systems of equations of the pressure and the
+ *        transport stages of the sequential implicit scheme for the black-oil model.
+ *
+ * Both stages are derived from the Jacobian matrix of the fully implicit system. For
+ * each cell, the conservation equations are combined using quasi-IMPES weights, i.e.,
+ * the weights eliminate the derivatives of the cell's own residual with respect to
+ * all primary variables except the pressure. The resulting scalar pressure equation
+ * is solved using an algebraic multigrid preconditioner while the saturations and
+ * compositions are kept fixed.
+ *
+ * The transport stage keeps the pressure fixed and solves the conservation equations
+ * except the one with the largest weight, which is replaced by the pressure equation.
+ * If both stages are converged, the residual of the fully implicit system is thus
+ * zero as well.
+ *
+ * The weights are computed for the pressure stage and reused by the subsequent
+ * transport stage. The hierarchy of the algebraic multigrid is set up by the first
+ * pressure stage of each time step; the later pressure stages of the time step only
+ * recompute its coarse matrices for the new values of the pressure matrix.
+ */
+template <class TypeTag>
+class BlackOilSequentialSolver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+
+    using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { pressureIdx = Indices::pressureSwitchIdx };
+
+    using WeightVector = Dune::FieldVector<Scalar, numEq>;
+    using DiagonalBlock = Dune::FieldMatrix<Scalar, numEq, numEq>;
+
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1>>;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1>>;
+    using PressureOperator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using PressureSmoother = Dune::SeqSOR<PressureMatrix, PressureVector, PressureVector>;
+    using PressureAmg = Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother>;
+
+    // the AMG stops coarsening below this number of unknowns
+    static constexpr int coarsenTarget = 1000;
+    static constexpr int maxPressureIterations = 200;
+
+public:
+    BlackOilSequentialSolver(const Simulator& simulator)
+        : simulator_(simulator)
+    { }
+
+    /*!
+     * \brief Indicates the beginning of a time step.
+     *
+     * This causes the hierarchy of the algebraic multigrid to be set up again by the
+     * next pressure stage.
+     */
+    void beginTimeStep()
+    { pressureAmg_.reset(); }
+
+    /*!
+     * \brief Compute the quasi-IMPES weights of each cell and determine the
+     *        conservation equation which is replaced by the pressure equation.
+     *
+     * \param jacobian The Jacobian matrix of the fully implicit system
+     */
+    void updateWeights(const SparseMatrixAdapter& jacobian)
+    {
+        const IstlMatrix& matrix = jacobian.istlMatrix();
+        size_t numRows = matrix.N();
+        weights_.resize(numRows);
+        replacedEq_.resize(numRows);
+
+        WeightVector unitPressure(0.0);
+        unitPressure[pressureIdx] = 1.0;
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            // solve D^T w = e_p, where D is the diagonal block of the cell
+            const auto& diagBlock = matrix[rowIdx][rowIdx];
+            DiagonalBlock transposedBlock;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    transposedBlock[pvIdx][eqIdx] = diagBlock[eqIdx][pvIdx];
+            transposedBlock.solve(weights_[rowIdx], unitPressure);
+
+            unsigned replacedEq = 0;
+            for (unsigned eqIdx = 1; eqIdx < numEq; ++eqIdx)
+                if (std::abs(weights_[rowIdx][eqIdx]) > std::abs(weights_[rowIdx][replacedEq]))
+                    replacedEq = eqIdx;
+            replacedEq_[rowIdx] = replacedEq;
+        }
+    }
+
+    /*!
+     * \brief Solve the pressure equation.
+     *
+     * updateWeights() must have been called for the Jacobian matrix beforehand.
+     * The hierarchy of the algebraic multigrid is reused until the next call to
+     * beginTimeStep(), i.e., only its coarse matrices are updated.
+     *
+     * \param jacobian The Jacobian matrix of the fully implicit system
+     * \param residual The residual of the fully implicit system
+     * \param update Receives the update of the solution. Only the pressure is non-zero.
+     * \param tolerance The reduction of the defect which is required from the solver
+     * \return true if the linear solver converged
+     */
+    bool solvePressure(const SparseMatrixAdapter& jacobian,
+                       const GlobalEqVector& residual,
+                       GlobalEqVector& update,
+                       Scalar tolerance)
+    {
+        const IstlMatrix& matrix = jacobian.istlMatrix();
+        if (!pressureMatrix_ || pressureMatrix_->N() != matrix.N()) {
+            createPressureMatrix_(matrix);
+            pressureAmg_.reset();
+        }
+
+        size_t numRows = matrix.N();
+        PressureVector rhs(numRows);
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& weights = weights_[rowIdx];
+            auto pressureColIt = (*pressureMatrix_)[rowIdx].begin();
+            const auto& colEndIt = matrix[rowIdx].end();
+            for (auto colIt = matrix[rowIdx].begin(); colIt != colEndIt; ++colIt, ++pressureColIt) {
+                Scalar value = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += weights[eqIdx]*(*colIt)[eqIdx][pressureIdx];
+                *pressureColIt = value;
+            }
+
+            rhs[rowIdx] = weights*residual[rowIdx];
+        }
+
+        if (pressureAmg_)
+            pressureAmg_->recalculateHierarchy();
+        else
+            createPressureAmg_();
+
+        Dune::BiCGSTABSolver<PressureVector> solver(*pressureOperator_,
+                                                    *pressureAmg_,
+                                                    tolerance,
+                                                    maxPressureIterations,
+                                                    /*verbosity=*/0);
+
+        PressureVector pressureUpdate(numRows);
+        pressureUpdate = 0.0;
+        Dune::InverseOperatorResult result;
+        solver.apply(pressureUpdate, rhs, result);
+
+        update = 0.0;
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            update[rowIdx][pressureIdx] = pressureUpdate[rowIdx];
+
+        return result.converged;
+    }
+
+    /*!
+     * \brief Set up the linear system of equations of the transport stage.
+     *
+     * In the resulting system, the update of the pressure is zero. The weights of the
+     * last pressure stage are used; they are only computed if none are available.
+     *
+     * \param jacobian The Jacobian matrix of the fully implicit system
+     * \param residual The residual of the fully implicit system
+     */
+    void assembleTransport(const SparseMatrixAdapter& jacobian,
+                           const GlobalEqVector& residual)
+    {
+        const IstlMatrix& matrix = jacobian.istlMatrix();
+        if (replacedEq_.size() != matrix.N())
+            updateWeights(jacobian);
+
+        if (!transportMatrix_ || transportMatrix_->rows() != matrix.N())
+            createTransportMatrix_(matrix);
+
+        IstlMatrix& transportMatrix = transportMatrix_->istlMatrix();
+        transportResidual_ = residual;
+
+        size_t numRows = matrix.N();
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            unsigned replacedEq = replacedEq_[rowIdx];
+            auto transportColIt = transportMatrix[rowIdx].begin();
+            const auto& colEndIt = matrix[rowIdx].end();
+            for (auto colIt = matrix[rowIdx].begin(); colIt != colEndIt; ++colIt, ++transportColIt) {
+                *transportColIt = *colIt;
+                (*transportColIt)[replacedEq] = 0.0;
+            }
+
+            // the equation which has been taken care of by the pressure stage is
+            // replaced by the condition that the pressure does not change
+            transportMatrix[rowIdx][rowIdx][replacedEq][pressureIdx] = 1.0;
+            transportResidual_[rowIdx][replacedEq] = 0.0;
+        }
+    }
+
+    /*!
+     * \brief Returns the matrix of the transport stage.
+     */
+    const SparseMatrixAdapter& transportMatrix() const
+    { return *transportMatrix_; }
+
+    /*!
+     * \brief Returns the right hand side of the transport stage.
+     */
+    const GlobalEqVector& transportResidual() const
+    { return transportResidual_; }
+
+private:
+    void createPressureMatrix_(const IstlMatrix& matrix)
+    {
+        pressureMatrix_.reset(new PressureMatrix(matrix.N(),
+                                                 matrix.M(),
+                                                 matrix.nonzeroes(),
+                                                 PressureMatrix::row_wise));
+        for (auto rowIt = pressureMatrix_->createbegin(); rowIt != pressureMatrix_->createend(); ++rowIt) {
+            const auto& row = matrix[rowIt.index()];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                rowIt.insert(colIt.index());
+        }
+    }
+
+    void createPressureAmg_()
+    {
+        using SmootherArgs = typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments;
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, coarsenTarget);
+        coarsenCriterion.setDefaultValuesAnisotropic(GridView::dimension,
+                                                     /*aggregateSizePerDim=*/3);
+        coarsenCriterion.setDebugLevel(0);
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        // the operator refers to the pressure matrix, so the fine level of the
+        // hierarchy sees the values of later pressure stages
+        pressureOperator_.reset(new PressureOperator(*pressureMatrix_));
+        pressureAmg_.reset(new PressureAmg(*pressureOperator_, coarsenCriterion, smootherArgs));
+    }
+
+    void createTransportMatrix_(const IstlMatrix& matrix)
+    {
+        std::vector<std::set<unsigned>> sparsityPattern(matrix.N());
+        for (size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx) {
+            const auto& row = matrix[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                sparsityPattern[rowIdx].insert(static_cast<unsigned>(colIt.index()));
+        }
+
+        transportMatrix_.reset(new SparseMatrixAdapter(simulator_));
+        transportMatrix_->reserve(sparsityPattern);
+    }
+
+    const Simulator& simulator_;
+
+    // the quasi-IMPES weights of each cell and the index of the conservation equation
+    // which is replaced by the pressure equation
+    std::vector<WeightVector> weights_;
+    std::vector<unsigned> replacedEq_;
+
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    std::unique_ptr<PressureOperator> pressureOperator_;
+    std::unique_ptr<PressureAmg> pressureAmg_;
+    std::unique_ptr<SparseMatrixAdapter> transportMatrix_;
+    GlobalEqVector transportResidual_;
+};
+
+} // namespace Opm
+
+#endif
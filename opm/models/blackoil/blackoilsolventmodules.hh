@@ -31,6 +31,8 @@
 #include "blackoilproperties.hh"
 #include <opm/models/io/vtkblackoilsolventmodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/regiontablearena.hh>
+#include <opm/models/utils/tabulatedsegmenthint.hh>
 
 #include <opm/material/fluidsystems/blackoilpvt/SolventPvt.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
@@ -77,11 +79,13 @@ class BlackOilSolventModule
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using RateVector = GetPropType<TypeTag, Properties::RateVector>;
     using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Toolbox = MathToolbox<Evaluation>;
     using SolventPvt = ::Opm::SolventPvt<Scalar>;
 
     using TabulatedFunction = Tabulated1DFunction<Scalar>;
+    using CompactTabulatedFunction = CompactTabulated1DFunction<Scalar>;
 
     static constexpr unsigned solventSaturationIdx = Indices::solventSaturationIdx;
     static constexpr unsigned contiSolventEqIdx = Indices::contiSolventEqIdx;
@@ -337,6 +341,8 @@ public:
                     setTlpmixpa(regionIdx, ones);
             }
         }
+
+        setTableStorage_();
     }
 #endif
 
@@ -349,6 +355,7 @@ public:
     {
         ssfnKrg_.resize(numRegions);
         ssfnKrs_.resize(numRegions);
+        tableArena_().invalidate();
     }
 
     /*!
@@ -362,6 +369,7 @@ public:
     {
         ssfnKrg_[satRegionIdx] = ssfnKrg;
         ssfnKrs_[satRegionIdx] = ssfnKrs;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -373,6 +381,7 @@ public:
                         const TabulatedFunction& sof2Krn)
     {
         sof2Krn_[satRegionIdx] = sof2Krn;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -384,6 +393,7 @@ public:
                         const TabulatedFunction& misc)
     {
         misc_[miscRegionIdx] = misc;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -395,6 +405,7 @@ public:
                         const TabulatedFunction& pmisc)
     {
         pmisc_[miscRegionIdx] = pmisc;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -408,6 +419,7 @@ public:
     {
         msfnKrsg_[satRegionIdx] = msfnKrsg;
         msfnKro_[satRegionIdx] = msfnKro;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -419,6 +431,7 @@ public:
                         const TabulatedFunction& sorwmis)
     {
         sorwmis_[miscRegionIdx] = sorwmis;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -430,6 +443,7 @@ public:
                         const TabulatedFunction& sgcwmis)
     {
         sgcwmis_[miscRegionIdx] = sgcwmis;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -454,6 +468,7 @@ public:
                         const TabulatedFunction& tlPMixTable)
     {
         tlPMixTable_[miscRegionIdx] = tlPMixTable;
+        tableArena_().invalidate();
     }
 
     /*!
@@ -675,6 +690,43 @@ public:
     static const SolventPvt& solventPvt()
     { return solventPvt_; }
 
+    //! The region tables of the module, cf. evalRegionTable()
+    enum RegionTableGroup {
+        ssfnKrgGroup,
+        ssfnKrsGroup,
+        sof2KrnGroup,
+        miscGroup,
+        pmiscGroup,
+        msfnKrsgGroup,
+        msfnKroGroup,
+        sorwmisGroup,
+        sgcwmisGroup,
+        tlPMixGroup,
+        numRegionTableGroups
+    };
+
+    /*!
+     * \brief Evaluate a region table of the module at a given position.
+     *
+     * If the region tables are stored in single precision or replicated for each NUMA
+     * domain, the copy packed by the table arena is used. Otherwise, the table is
+     * accessed directly, i.e., the same as by the accessor of the table.
+     */
+    template <class LhsEval>
+    static LhsEval evalRegionTable(TabulatedSegmentHint& hint,
+                                   RegionTableGroup groupIdx,
+                                   const ElementContext& elemCtx,
+                                   unsigned scvIdx,
+                                   unsigned timeIdx,
+                                   const LhsEval& x)
+    {
+        unsigned regionIdx = regionIndex_(groupIdx, elemCtx, scvIdx, timeIdx);
+        if (useTableArena_)
+            return hint.eval(regionTable_(groupIdx, regionIdx), x, /*extrapolate=*/true);
+
+        return hint.eval((*tableGroups_[groupIdx])[regionIdx], x, /*extrapolate=*/true);
+    }
+
     static const TabulatedFunction& ssfnKrg(const ElementContext& elemCtx,
                                             unsigned scvIdx,
                                             unsigned timeIdx)
@@ -777,6 +829,53 @@ public:
     }
 
 private:
+    static void setTableStorage_()
+    {
+        unsigned numReplicas = 1;
+        if (EWOMS_GET_PARAM(TypeTag, bool, ReplicateRegionTables))
+            numReplicas = ThreadManager::numNumaDomains();
+
+        bool useFloat = EWOMS_GET_PARAM(TypeTag, bool, RegionTablesUseFloat);
+        tableArena_().setStorage(useFloat,
+                                 EWOMS_GET_PARAM(TypeTag, Scalar, RegionTablesFloatTolerance),
+                                 numReplicas);
+
+        // with the default storage, the packed tables would be plain copies
+        useTableArena_ = useFloat || numReplicas > 1;
+    }
+
+    static unsigned regionIndex_(RegionTableGroup groupIdx,
+                                 const ElementContext& elemCtx,
+                                 unsigned scvIdx,
+                                 unsigned timeIdx)
+    {
+        switch (groupIdx) {
+        case miscGroup:
+        case pmiscGroup:
+        case sorwmisGroup:
+        case sgcwmisGroup:
+        case tlPMixGroup:
+            return elemCtx.problem().miscnumRegionIndex(elemCtx, scvIdx, timeIdx);
+        default:
+            return elemCtx.problem().satnumRegionIndex(elemCtx, scvIdx, timeIdx);
+        }
+    }
+
+    static const CompactTabulatedFunction& regionTable_(unsigned groupIdx, unsigned regionIdx)
+    { return tableArena_().table(groupIdx, regionIdx, ThreadManager::numaDomain()); }
+
+    static RegionTableArena<Scalar>& tableArena_()
+    {
+        static RegionTableArena<Scalar> arena(std::vector<const std::vector<TabulatedFunction>*>(
+                                                  std::begin(tableGroups_), std::end(tableGroups_)));
+        return arena;
+    }
+
+    // the tables of each region table group and whether they are evaluated using the
+    // table arena
+    static const std::vector<TabulatedFunction>* const tableGroups_[numRegionTableGroups];
+    static bool useTableArena_;
+
     static SolventPvt solventPvt_;
 
     static std::vector<TabulatedFunction> ssfnKrg_; // the krg(Fs) column of the SSFN table
@@ -853,6 +952,38 @@ template <class TypeTag, bool enableSolventV>
 bool
 BlackOilSolventModule<TypeTag, enableSolventV>::isMiscible_;
 
+// the order must be the one of the region table groups
+template <class TypeTag, bool enableSolventV>
+const std::vector<typename BlackOilSolventModule<TypeTag, enableSolventV>::TabulatedFunction>* const
+BlackOilSolventModule<TypeTag, enableSolventV>::tableGroups_[] = {
+    &ssfnKrg_, &ssfnKrs_, &sof2Krn_, &misc_, &pmisc_, &msfnKrsg_, &msfnKro_, &sorwmis_,
+    &sgcwmis_, &tlPMixTable_
+};
+
+template <class TypeTag, bool enableSolventV>
+bool
+BlackOilSolventModule<TypeTag, enableSolventV>::useTableArena_ = false;
+
+
+/*!
+ * \ingroup BlackOil
+ *
+ * \brief The segments of the tables of the solvent extension which were used by the last
+ *        update of the intensive quantities of a degree of freedom.
+ */
+struct BlackOilSolventTableHints
+{
+    TabulatedSegmentHint pmisc;
+    TabulatedSegmentHint misc;
+    TabulatedSegmentHint sorwmis;
+    TabulatedSegmentHint sgcwmis;
+    TabulatedSegmentHint msfnKrsg;
+    TabulatedSegmentHint msfnKro;
+    TabulatedSegmentHint sof2Krn;
+    TabulatedSegmentHint ssfnKrs;
+    TabulatedSegmentHint ssfnKrg;
+    TabulatedSegmentHint tlPMix;
+};
 
 /*!
  * \ingroup BlackOil
@@ -898,6 +1029,13 @@ public:
         const PrimaryVariables& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
         auto& fs = asImp_().fluidState_;
         solventSaturation_ = priVars.makeEvaluation(solventSaturationIdx, timeIdx, elemCtx.linearizationType());
+
+        // start the table lookups at the segments which were used by the last update
+        // of the degree of freedom. the hints are only available to the element which
+        // owns the degree of freedom; the other ones start at the last segments used by
+        // their element context.
+        if (const auto* tableHints = elemCtx.model().tableHints(elemCtx, dofIdx, timeIdx))
+            solventTableHints_ = tableHints->solvent;
         hydrocarbonSaturation_ = fs.saturation(gasPhaseIdx);
 
         // apply a cut-off. Don't waste calculations if no solvent
@@ -934,7 +1072,7 @@ public:
         // Pressure effects on capillary pressure miscibility
         if (SolventModule::isMiscible()) {
             const Evaluation& p = fs.pressure(oilPhaseIdx); // or gas pressure?
-            const Evaluation pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx).eval(p, /*extrapolate=*/true);
+            const Evaluation pmisc = SolventModule::evalRegionTable(solventTableHints_.pmisc, SolventModule::pmiscGroup, elemCtx, dofIdx, timeIdx, p);
             const Evaluation& pgImisc = fs.pressure(gasPhaseIdx);
 
             // compute capillary pressure for miscible fluid
@@ -968,10 +1106,8 @@ public:
 
         // account for miscibility of oil and solvent
         if (SolventModule::isMiscible()) {
-            const auto& misc = SolventModule::misc(elemCtx, dofIdx, timeIdx);
-            const auto& pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx);
             const Evaluation& p = fs.pressure(oilPhaseIdx); // or gas pressure?
-            const Evaluation miscibility = misc.eval(Fsolgas, /*extrapolate=*/true) * pmisc.eval(p, /*extrapolate=*/true);
+            const Evaluation miscibility = SolventModule::evalRegionTable(solventTableHints_.misc, SolventModule::miscGroup, elemCtx, dofIdx, timeIdx, Fsolgas) * SolventModule::evalRegionTable(solventTableHints_.pmisc, SolventModule::pmiscGroup, elemCtx, dofIdx, timeIdx, p);
 
             // TODO adjust endpoints of sn and ssg
             unsigned cellIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
@@ -982,11 +1118,9 @@ public:
             const Scalar& sgcr = scaledDrainageInfo.Sgcr;
             const Scalar& sogcr = scaledDrainageInfo.Sogcr;
             const Evaluation& sw = fs.saturation(waterPhaseIdx);
-            const auto& sorwmis = SolventModule::sorwmis(elemCtx, dofIdx, timeIdx);
-            const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, dofIdx, timeIdx);
 
-            Evaluation sor = miscibility * sorwmis.eval(sw,  /*extrapolate=*/true) + (1.0 - miscibility) * sogcr;
-            Evaluation sgc = miscibility * sgcwmis.eval(sw,  /*extrapolate=*/true) + (1.0 - miscibility) * sgcr;
+            Evaluation sor = miscibility * SolventModule::evalRegionTable(solventTableHints_.sorwmis, SolventModule::sorwmisGroup, elemCtx, dofIdx, timeIdx, sw) + (1.0 - miscibility) * sogcr;
+            Evaluation sgc = miscibility * SolventModule::evalRegionTable(solventTableHints_.sgcwmis, SolventModule::sgcwmisGroup, elemCtx, dofIdx, timeIdx, sw) + (1.0 - miscibility) * sgcr;
 
             const Evaluation oilGasSolventSat = gasSolventSat + fs.saturation(oilPhaseIdx);
             const Evaluation zero = 0.0;
@@ -997,12 +1131,9 @@ public:
                 const Evaluation gasSolventEffSat = std::max(gasSolventSat - sgc, zero);
                 F_totalGas = gasSolventEffSat / oilGasSolventEffSat;
             }
-            const auto& msfnKro = SolventModule::msfnKro(elemCtx, dofIdx, timeIdx);
-            const auto& msfnKrsg = SolventModule::msfnKrsg(elemCtx, dofIdx, timeIdx);
-            const auto& sof2Krn = SolventModule::sof2Krn(elemCtx, dofIdx, timeIdx);
 
-            const Evaluation mkrgt = msfnKrsg.eval(F_totalGas, /*extrapolate=*/true) * sof2Krn.eval(oilGasSolventSat, /*extrapolate=*/true);
-            const Evaluation mkro = msfnKro.eval(F_totalGas, /*extrapolate=*/true) * sof2Krn.eval(oilGasSolventSat, /*extrapolate=*/true);
+            const Evaluation mkrgt = SolventModule::evalRegionTable(solventTableHints_.msfnKrsg, SolventModule::msfnKrsgGroup, elemCtx, dofIdx, timeIdx, F_totalGas) * SolventModule::evalRegionTable(solventTableHints_.sof2Krn, SolventModule::sof2KrnGroup, elemCtx, dofIdx, timeIdx, oilGasSolventSat);
+            const Evaluation mkro = SolventModule::evalRegionTable(solventTableHints_.msfnKro, SolventModule::msfnKroGroup, elemCtx, dofIdx, timeIdx, F_totalGas) * SolventModule::evalRegionTable(solventTableHints_.sof2Krn, SolventModule::sof2KrnGroup, elemCtx, dofIdx, timeIdx, oilGasSolventSat);
 
             Evaluation& kro = asImp_().mobility_[oilPhaseIdx];
             Evaluation& krg = asImp_().mobility_[gasPhaseIdx];
@@ -1017,12 +1148,9 @@ public:
 
 
         // compute the mobility of the solvent "phase" and modify the gas phase
-        const auto& ssfnKrg = SolventModule::ssfnKrg(elemCtx, dofIdx, timeIdx);
-        const auto& ssfnKrs = SolventModule::ssfnKrs(elemCtx, dofIdx, timeIdx);
-
         Evaluation& krg = asImp_().mobility_[gasPhaseIdx];
-        solventMobility_ = krg * ssfnKrs.eval(Fsolgas, /*extrapolate=*/true);
-        krg *= ssfnKrg.eval(Fhydgas, /*extrapolate=*/true);
+        solventMobility_ = krg * SolventModule::evalRegionTable(solventTableHints_.ssfnKrs, SolventModule::ssfnKrsGroup, elemCtx, dofIdx, timeIdx, Fsolgas);
+        krg *= SolventModule::evalRegionTable(solventTableHints_.ssfnKrg, SolventModule::ssfnKrgGroup, elemCtx, dofIdx, timeIdx, Fhydgas);
 
     }
 
@@ -1053,7 +1181,9 @@ public:
 
         solventMobility_ /= solventViscosity_;
 
-
+        // keep the segments for the next update of the degree of freedom
+        if (auto* tableHints = elemCtx.model().tableHints(elemCtx, scvIdx, timeIdx))
+            tableHints->solvent = solventTableHints_;
     }
 
     const Evaluation& solventSaturation() const
@@ -1093,14 +1223,12 @@ private:
         auto& fs = asImp_().fluidState_;
 
         // Compute effective saturations
-        const auto& sorwmis = SolventModule::sorwmis(elemCtx, scvIdx, timeIdx);
-        const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, scvIdx, timeIdx);
         const Evaluation& sw = fs.saturation(waterPhaseIdx);
 
         const Evaluation zero = 0.0;
-        const Evaluation oilEffSat = std::max(fs.saturation(oilPhaseIdx) - sorwmis.eval(sw,  /*extrapolate=*/true),zero);
-        const Evaluation gasEffSat = std::max(fs.saturation(gasPhaseIdx) - sgcwmis.eval(sw,  /*extrapolate=*/true),zero);
-        const Evaluation solventEffSat = std::max(solventSaturation() - sgcwmis.eval(sw,  /*extrapolate=*/true),zero);
+        const Evaluation oilEffSat = std::max(fs.saturation(oilPhaseIdx) - SolventModule::evalRegionTable(solventTableHints_.sorwmis, SolventModule::sorwmisGroup, elemCtx, scvIdx, timeIdx, sw),zero);
+        const Evaluation gasEffSat = std::max(fs.saturation(gasPhaseIdx) - SolventModule::evalRegionTable(solventTableHints_.sgcwmis, SolventModule::sgcwmisGroup, elemCtx, scvIdx, timeIdx, sw),zero);
+        const Evaluation solventEffSat = std::max(solventSaturation() - SolventModule::evalRegionTable(solventTableHints_.sgcwmis, SolventModule::sgcwmisGroup, elemCtx, scvIdx, timeIdx, sw),zero);
 
         const Evaluation oilGasSolventEffSat =  oilEffSat + gasEffSat + solventEffSat;
         const Evaluation oilSolventEffSat = oilEffSat + solventEffSat;
@@ -1135,8 +1263,7 @@ private:
         // The pressureMixingParameter represent the miscibility of the solvent while the mixingParameterViscosity the effect of the porous media.
         // The pressureMixingParameter is not implemented in ecl100.
         const Evaluation& po = fs.pressure(oilPhaseIdx);
-        const auto& tlPMixTable = SolventModule::tlPMixTable(elemCtx, scvIdx, timeIdx);
-        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(po,  /*extrapolate=*/true);
+        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * SolventModule::evalRegionTable(solventTableHints_.tlPMix, SolventModule::tlPMixGroup, elemCtx, scvIdx, timeIdx, po);
 
         Evaluation muOilEff = pow(muOil,1.0 - tlMixParamMu) * pow(muMixOilSolvent, tlMixParamMu);
         Evaluation muGasEff = pow(muGas,1.0 - tlMixParamMu) * pow(muMixSolventGas, tlMixParamMu);
@@ -1150,7 +1277,7 @@ private:
         // Mixing parameter for density
         // The pressureMixingParameter represent the miscibility of the solvent while the mixingParameterDenisty the effect of the porous media.
         // The pressureMixingParameter is not implemented in ecl100.
-        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(po,  /*extrapolate=*/true);
+        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * SolventModule::evalRegionTable(solventTableHints_.tlPMix, SolventModule::tlPMixGroup, elemCtx, scvIdx, timeIdx, po);
 
         // compute effective viscosities for density calculations. These have to
         // be recomputed as a different mixing parameter may be used.
@@ -1204,8 +1331,7 @@ private:
         const Evaluation bSolventEff = rhoSolventEff / solventRefDensity();
 
         // account for pressure effects
-        const auto& pmiscTable = SolventModule::pmisc(elemCtx, scvIdx, timeIdx);
-        const Evaluation pmisc = pmiscTable.eval(po, /*extrapolate=*/true);
+        const Evaluation pmisc = SolventModule::evalRegionTable(solventTableHints_.pmisc, SolventModule::pmiscGroup, elemCtx, scvIdx, timeIdx, po);
 
         // copy the unmodified invB factors
         const Evaluation bo = fs.invB(oilPhaseIdx);
@@ -1256,6 +1382,9 @@ protected:
     Evaluation solventInvFormationVolumeFactor_;
 
     Scalar solventRefDensity_;
+
+    // the segments of the tables which were used by the last lookups
+    BlackOilSolventTableHints solventTableHints_;
 };
 
 template <class TypeTag>
@@ -30,6 +30,8 @@
 
 #include "fvbaseproperties.hh"
 
+#include <opm/models/utils/profiler.hh>
+
 #include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -173,8 +175,14 @@ public:
      */
     void linearize(ElementContext& elemCtx, const Element& elem)
     {
-        elemCtx.updateStencil(elem);
-        elemCtx.updateAllIntensiveQuantities();
+        {
+            ProfilerRegion profilerRegion("stencil update", /*traced=*/false);
+            elemCtx.updateStencil(elem);
+        }
+        {
+            ProfilerRegion profilerRegion("intensive quantities", /*traced=*/false);
+            elemCtx.updateAllIntensiveQuantities();
+        }
 
         // update the weights of the primary variables for the context
         model_().updatePVWeights(elemCtx);
@@ -187,10 +195,19 @@ public:
         unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned focusDofIdx = 0; focusDofIdx < numPrimaryDof; focusDofIdx++) {
             elemCtx.setFocusDofIndex(focusDofIdx);
-            elemCtx.updateAllExtensiveQuantities();
 
-            // calculate the local residual
-            localResidual_.eval(elemCtx);
+            {
+                ProfilerRegion profilerRegion("fluxes and local residual", /*traced=*/false);
+                if (focusDofIdx == 0)
+                    elemCtx.updateAllExtensiveQuantities();
+                else
+                    // the gradient calculator only depends on the geometry of the element,
+                    // so it does not need to be prepared again if only the focus changes
+                    elemCtx.updateFocusedExtensiveQuantities(/*timeIdx=*/0);
+
+                // calculate the local residual
+                localResidual_.eval(elemCtx);
+            }
 
             // convert the local Jacobian matrix and the right hand side from the data
             // structures used by the automatic differentiation code to the conventional
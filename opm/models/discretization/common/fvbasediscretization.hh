@@ -46,6 +46,7 @@
 #include "fvbaseintensivequantities.hh"
 #include "fvbaseextensivequantities.hh"
 #include "baseauxiliarymodule.hh"
+#include "timestepcontrollers.hh"
 
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
@@ -54,6 +55,7 @@
 #include <opm/models/utils/alignedallocator.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/utils/cuthillmckee.hh>
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
 
@@ -74,10 +76,17 @@
 #include <dune/fem/misc/capabilities.hh>
 #endif
 
+#include <algorithm>
+#include <cstdint>
+#include <exception>
 #include <limits>
 #include <list>
+#include <mutex>
+#include <ostream>
+#include <set>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace Opm {
@@ -136,6 +145,39 @@ struct MaxTimeStepDivisions<TypeTag, TTag::FvBaseDiscretization> { static conste
 template<class TypeTag>
 struct ContinueOnConvergenceError<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+//! By default, the time step size is determined by the iterations of the Newton method
+template<class TypeTag>
+struct TimeStepController<TypeTag, TTag::FvBaseDiscretization>
+{ using type = IterationCountTimeStepController<TypeTag>; };
+
+//! Aim at a weighted change of 10% of the primary variables per time step
+template<class TypeTag>
+struct TimeStepControlTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+
+//! Allow the time step size to at most triple between two time steps
+template<class TypeTag>
+struct TimeStepControlMaxGrowth<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 3.0;
+};
+
+//! Retry failed time steps using half the size
+template<class TypeTag>
+struct TimeStepControlRetryFactor<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.5;
+};
+
+//! Start the Newton method at the solution of the previous time step by default
+template<class TypeTag>
+struct EnableSolutionPredictor<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 /*!
  * \brief A vector of quanties, each for one equation.
  */
@@ -219,8 +261,30 @@ struct ThreadManager<TypeTag, TTag::FvBaseDiscretization> { using type = ::Opm::
 template<class TypeTag>
 struct ThreadsPerProcess<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
 template<class TypeTag>
+struct NumaDomains<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
+template<class TypeTag>
 struct UseLinearizationLock<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
 
+//! linearize the elements one by one by default
+template<class TypeTag>
+struct UseColoredFiniteDifferences<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! visit the elements in the order of the grid by default
+template<class TypeTag>
+struct EnableElementReordering<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! linearize all elements in each iteration by default
+template<class TypeTag>
+struct EnableLocalizedLinearization<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct LocalizedLinearizationTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-6;
+};
+template<class TypeTag>
+struct LocalizedLinearizationFullInterval<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 4; };
+
 /*!
  * \brief Linearizer for the global system of equations.
  */
@@ -261,6 +325,10 @@ struct EnableVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr b
 template<class TypeTag>
 struct EnableAsyncVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
 
+//! Allow two time steps to be queued for asynchronous VTK output
+template<class TypeTag>
+struct VtkOutputQueueSize<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 2; };
+
 //! Set the format of the VTK output to ASCII by default
 template<class TypeTag>
 struct VtkOutputFormat<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = Dune::VTK::ascii; };
@@ -374,6 +442,7 @@ class FvBaseDiscretization
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Toolbox = MathToolbox<Evaluation>;
     using VectorBlock = Dune::FieldVector<Evaluation, numEq>;
@@ -436,10 +505,14 @@ public:
 #else
         , space_( asImp_().numGridDof() )
 #endif
+        , storageCacheUpToDate_(false)
         , enableGridAdaptation_( EWOMS_GET_PARAM(TypeTag, bool, EnableGridAdaptation) )
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , enableSolutionPredictor_(EWOMS_GET_PARAM(TypeTag, bool, EnableSolutionPredictor))
+        , predictorTimeStepSize_(0.0)
+        , solutionPredicted_(false)
     {
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
@@ -507,6 +580,12 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableElementReordering,
+                             "Linearize the elements in reverse Cuthill-McKee order to improve the "
+                             "memory locality of neighboring elements");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableSolutionPredictor,
+                             "Extrapolate the initial guess of the Newton method from the "
+                             "solutions of the last two time steps");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
     }
 
@@ -515,6 +594,10 @@ public:
      */
     void finishInit()
     {
+        if (enableSolutionPredictor_ && !asImp_().solutionPredictorSupported())
+            throw std::runtime_error("The solution predictor is not supported by the model "
+                                     "used by the problem");
+
         // initialize the volume of the finite volumes to zero
         size_t numDof = asImp_().numGridDof();
         dofTotalVolume_.resize(numDof);
@@ -573,15 +656,29 @@ public:
             localLinearizer_[threadId].init(simulator_);
 
         resizeAndResetIntensiveQuantitiesCache_();
+        updateDofOwners_();
         if (storeIntensiveQuantities()) {
             // invalidate all cached intensive quantities
             for (unsigned timeIdx = 0; timeIdx < historySize; ++ timeIdx)
                 invalidateIntensiveQuantitiesCache(timeIdx);
         }
 
+        updateElementOrdering_();
+
         newtonMethod_.finishInit();
     }
 
+    /*!
+     * \brief Returns the order in which the elements should be linearized.
+     *
+     * If the EnableElementReordering parameter is set, this is the reverse
+     * Cuthill-McKee ordering of the element adjacency graph of the local grid
+     * partition, i.e., subsequently visited elements tend to share their neighbors. If
+     * the vector is empty, the order of the grid's element iterator is used.
+     */
+    const std::vector<ElementSeed>& elementOrdering() const
+    { return elementOrdering_; }
+
     /*!
      * \brief Returns whether the grid ought to be adapted to the solution during the simulation.
      */
@@ -636,6 +733,8 @@ public:
         for (unsigned timeIdx = 1; timeIdx < historySize; ++timeIdx)
             solution(timeIdx) = solution(/*timeIdx=*/0);
 
+        storageCacheUpToDate_ = false;
+
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx)  {
             const auto& sol = solution(timeIdx);
@@ -765,11 +864,30 @@ public:
         }
     }
 
-    void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
+    /*!
+     * \brief Compute all intensive quantities of a time index which are not cached yet
+     *        in a single sweep over the grid.
+     *
+     * The intensive quantities of each degree of freedom are evaluated once by the
+     * element which owns it (cf. dofOwner()) and are written to the cache directly,
+     * i.e., the linearization of the elements afterwards only copies them. This method
+     * does nothing if the intensive quantity cache is disabled.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    void updateIntensiveQuantitiesCache(unsigned timeIdx) const
     {
-        invalidateIntensiveQuantitiesCache(timeIdx);
+        if (!enableIntensiveQuantityCache_)
+            return;
+
+        assert(dofOwner_.size() == asImp_().numGridDof());
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
 
-        // loop over all elements...
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
 #ifdef _OPENMP
 #pragma omp parallel
@@ -777,12 +895,34 @@ public:
         {
             ElementContext elemCtx(simulator_);
             ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                elemCtx.updatePrimaryStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    elemCtx.updatePrimaryStencil(elem);
+                    elemCtx.updatePrimaryIntensiveQuantitiesCache(timeIdx);
+                }
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
             }
         }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    /*!
+     * \brief Invalidate the intensive quantity cache for a time index and re-populate it
+     *        in a single sweep over the grid.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
+    {
+        invalidateIntensiveQuantitiesCache(timeIdx);
+        updateIntensiveQuantitiesCache(timeIdx);
     }
 
     /*!
@@ -868,6 +1008,119 @@ public:
         storageCache_[timeIdx][globalIdx] = value;
     }
 
+    /*!
+     * \brief Returns true iff the storage cache holds the storage term of the previous
+     *        time step for all degrees of freedom.
+     *
+     * This is the case after updateStorageCache() has been called and stays the case
+     * until the model advances to the next time level.
+     */
+    bool storageCacheUpToDate() const
+    { return storageCacheUpToDate_; }
+
+    /*!
+     * \brief Returns the index of the element which is responsible for a degree of
+     *        freedom.
+     *
+     * This is the first interior element of the grid which contains the degree of
+     * freedom, or the first element if there is no such element. For the
+     * element-centered finite volume discretization, it is the element of the degree
+     * of freedom itself. Data which is stored for each degree of freedom
+     * and which is written while the grid is traversed in parallel can be written by
+     * this element only, so that no two threads access the same entry.
+     *
+     * \param globalIdx The global space index of the degree of freedom
+     */
+    unsigned dofOwner(unsigned globalIdx) const
+    { return dofOwner_[globalIdx]; }
+
+    /*!
+     * \brief Returns true if the storage term of the first iteration of the current
+     *        time step can be used as the one of the previous time step.
+     *
+     * This is the case if the problem allows it and the solution of the current time
+     * step was not extrapolated by the solution predictor, i.e., if the initial guess
+     * of the Newton method is the solution of the previous time step.
+     */
+    bool recycleFirstIterationStorage() const
+    { return simulator_.problem().recycleFirstIterationStorage() && !solutionPredicted_; }
+
+    /*!
+     * \brief Compute the storage term at the beginning of the time step for all degrees
+     *        of freedom and store it in the storage cache.
+     *
+     * The interior elements of the grid are traversed in parallel and each degree of
+     * freedom is only handled by the element which owns it (cf. dofOwner()). For the
+     * vertex-centered finite volume discretization, this avoids evaluating the storage
+     * term of a vertex once for every adjacent element, and no two threads write to the
+     * same cache entry. The storage term of the remaining elements is not cached.
+     *
+     * If the storage term of the first iteration can be recycled (cf.
+     * recycleFirstIterationStorage()), this method must be called after the
+     * constraints have been applied to the solution of the current time step and
+     * before the solution gets modified by the first Newton update.
+     */
+    void updateStorageCache()
+    {
+        assert(enableStorageCache_);
+
+        assert(dofOwner_.size() == asImp_().numGridDof());
+
+        unsigned storageTimeIdx = recycleFirstIterationStorage() ? 0 : 1;
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext elemCtx(simulator_);
+            EqVector storage;
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    unsigned elemIdx = elementMapper_.index(elem);
+                    elemCtx.updatePrimaryStencil(elem);
+
+                    // only the intensive quantities of the DOFs owned by the element
+                    // are required
+                    size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        if (dofOwner_[globalIdx] != elemIdx)
+                            continue;
+
+                        elemCtx.updateDofIntensiveQuantities(dofIdx, storageTimeIdx);
+                        storage = 0.0;
+                        localResidual(threadId).computeStorage(storage, elemCtx, dofIdx, storageTimeIdx);
+                        Valgrind::CheckDefined(storage);
+                        storageCache_[/*timeIdx=*/1][globalIdx] = storage;
+                    }
+                }
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        storageCacheUpToDate_ = true;
+    }
+
     /*!
      * \brief Compute the global residual for an arbitrary solution
      *        vector.
@@ -1424,6 +1677,69 @@ public:
 #endif // NDEBUG
     }
 
+    /*!
+     * \brief Extrapolate the initial guess of the Newton method from the solutions of
+     *        the last two time steps.
+     *
+     * This is called by the problem before each attempt to compute a time step. If
+     * the solution predictor is disabled or the solution of the time step before the
+     * previous one is not available, the current solution is left alone. Since the
+     * extrapolated solution differs from the one of the previous time step, the
+     * storage cache is then always computed from the latter.
+     */
+    void predictSolution()
+    {
+        if (!enableSolutionPredictor_ || predictorTimeStepSize_ <= 0.0)
+            return;
+
+        const SolutionVector& prevSolution = solution(/*timeIdx=*/1);
+        if (predictorSolution_.size() != prevSolution.size())
+            return;
+
+        Scalar factor = simulator_.timeStepSize()/predictorTimeStepSize_;
+        SolutionVector& curSolution = solution(/*timeIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < curSolution.size(); ++dofIdx)
+            asImp_().extrapolatePrimaryVariables(curSolution[dofIdx],
+                                                 prevSolution[dofIdx],
+                                                 predictorSolution_[dofIdx],
+                                                 factor);
+        solutionPredicted_ = true;
+
+        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+    }
+
+    /*!
+     * \brief Returns true if the model can extrapolate its primary variables.
+     *
+     * The solution predictor must be explicitly enabled by each model because the
+     * linear extrapolation of extrapolatePrimaryVariables() is wrong if the meaning
+     * of a primary variable may change between time steps. Models which support the
+     * predictor overload this method and, if required, extrapolatePrimaryVariables().
+     */
+    bool solutionPredictorSupported() const
+    { return false; }
+
+    /*!
+     * \brief Linearly extrapolate the primary variables of a degree of freedom.
+     *
+     * This is only used if solutionPredictorSupported() returns true. Models for
+     * which some primary variables must not be extrapolated should overload it.
+     *
+     * \param result The extrapolated primary variables
+     * \param curPv The primary variables of the previous time step
+     * \param oldPv The primary variables of the time step before the previous one
+     * \param factor The ratio of the sizes of the current and the previous time steps
+     */
+    void extrapolatePrimaryVariables(PrimaryVariables& result,
+                                     const PrimaryVariables& curPv,
+                                     const PrimaryVariables& oldPv,
+                                     Scalar factor) const
+    {
+        result = curPv;
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+            result[pvIdx] += factor*(curPv[pvIdx] - oldPv[pvIdx]);
+    }
+
     /*!
      * \brief Called by the problem if a time integration was
      *        successful, post processing of the solution is done and
@@ -1436,8 +1752,19 @@ public:
         // at this point we can adapt the grid
         asImp_().adaptGrid();
 
+        // remember the previous solution for extrapolating the next one. (this is not
+        // possible if the grid may have changed in between.)
+        if (enableSolutionPredictor_ && !enableGridAdaptation_) {
+            predictorSolution_ = solution(/*timeIdx=*/1);
+            predictorTimeStepSize_ = simulator_.timeStepSize();
+        }
+
         // make the current solution the previous one.
         solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
+        solutionPredicted_ = false;
+
+        // the cached storage terms belong to the old previous solution
+        storageCacheUpToDate_ = false;
 
         // shift the intensive quantities cache by one position in the
         // history
@@ -1519,6 +1846,75 @@ public:
         }
     }
 
+    /*!
+     * \brief Write the current solution for a degree of freedom to a
+     *        binary restart file.
+     *
+     * If the primary variables are trivially copyable, their raw memory
+     * representation is written. Otherwise, the textual representation of
+     * serializeEntity() is stored as a length-prefixed record.
+     *
+     * \param outstream The stream into which the vertex data should
+     *                  be serialized to
+     * \param dof The Dune entity which's data should be serialized
+     */
+    template <class DofEntity>
+    void serializeEntityBinary(std::ostream& outstream,
+                               const DofEntity& dof)
+    {
+        unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
+
+        if constexpr (std::is_trivially_copyable<PrimaryVariables>::value) {
+            const PrimaryVariables& priVars = solution(/*timeIdx=*/0)[dofIdx];
+            outstream.write(reinterpret_cast<const char*>(&priVars), sizeof(PrimaryVariables));
+        }
+        else {
+            std::ostringstream oss;
+            oss.precision(20);
+            asImp_().serializeEntity(oss, dof);
+            const std::string& record = oss.str();
+            std::uint64_t recordLength = record.size();
+            outstream.write(reinterpret_cast<const char*>(&recordLength), sizeof(recordLength));
+            outstream.write(record.data(), static_cast<std::streamsize>(recordLength));
+        }
+
+        if (!outstream.good())
+            throw std::runtime_error("Could not serialize degree of freedom "
+                                     +std::to_string(dofIdx));
+    }
+
+    /*!
+     * \brief Reads the current solution variables for a degree of
+     *        freedom from a binary restart file.
+     *
+     * \param instream The stream from which the vertex data should
+     *                  be deserialized from
+     * \param dof The Dune entity which's data should be deserialized
+     */
+    template <class DofEntity>
+    void deserializeEntityBinary(std::istream& instream,
+                                 const DofEntity& dof)
+    {
+        unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
+
+        if constexpr (std::is_trivially_copyable<PrimaryVariables>::value) {
+            PrimaryVariables& priVars = solution(/*timeIdx=*/0)[dofIdx];
+            instream.read(reinterpret_cast<char*>(&priVars), sizeof(PrimaryVariables));
+        }
+        else {
+            std::uint64_t recordLength = 0;
+            instream.read(reinterpret_cast<char*>(&recordLength), sizeof(recordLength));
+            std::string record(static_cast<size_t>(recordLength), ' ');
+            instream.read(&record[0], static_cast<std::streamsize>(recordLength));
+            std::istringstream iss(record);
+            asImp_().deserializeEntity(iss, dof);
+        }
+
+        if (instream.fail())
+            throw std::runtime_error("Could not deserialize degree of freedom "
+                                     +std::to_string(dofIdx));
+    }
+
     /*!
      * \brief Returns the number of degrees of freedom (DOFs) for the computational grid
      */
@@ -1727,6 +2123,11 @@ public:
             needFullContextUpdate = needFullContextUpdate || (*modIt)->needExtensiveQuantities();
         }
 
+        // the threads process chunks of consecutive elements, so each thread writes to
+        // mostly contiguous ranges of the output buffers and the iterator does not
+        // need to be locked for every element
+        static constexpr unsigned chunkSize = 64;
+
         // iterate over grid
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
 #ifdef _OPENMP
@@ -1734,26 +2135,38 @@ public:
 #endif
         {
             ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const auto& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    // ignore non-interior entities
-                    continue;
-
-                if (needFullContextUpdate)
-                    elemCtx.updateAll(elem);
-                else {
-                    elemCtx.updatePrimaryStencil(elem);
-                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            unsigned numChunkElements;
+            ElementIterator elemIt = threadedElemIt.incrementChunk(chunkSize, numChunkElements);
+            while (numChunkElements > 0) {
+                for (unsigned i = 0; i < numChunkElements; ++i, ++elemIt) {
+                    const auto& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
+                        // ignore non-interior entities
+                        continue;
+
+                    // the output only considers the most recent solution, so the
+                    // intensive quantities of the previous time steps are not required
+                    // even if the storage cache is disabled. if available, the
+                    // intensive quantities are taken from the model's cache.
+                    if (needFullContextUpdate) {
+                        elemCtx.updateStencil(elem);
+                        elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+                        elemCtx.updateExtensiveQuantities(/*timeIdx=*/0);
+                    }
+                    else {
+                        elemCtx.updatePrimaryStencil(elem);
+                        elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+                    }
+
+                    // we cannot reuse the "modIt" variable here because the code here might
+                    // be threaded and "modIt" is is the same for all threads, i.e., if a
+                    // given thread modifies it, the changes affect all threads.
+                    auto modIt2 = outputModules_.begin();
+                    for (; modIt2 != modEndIt; ++modIt2)
+                        (*modIt2)->processElement(elemCtx);
                 }
 
-                // we cannot reuse the "modIt" variable here because the code here might
-                // be threaded and "modIt" is is the same for all threads, i.e., if a
-                // given thread modifies it, the changes affect all threads.
-                auto modIt2 = outputModules_.begin();
-                for (; modIt2 != modEndIt; ++modIt2)
-                    (*modIt2)->processElement(elemCtx);
+                elemIt = threadedElemIt.incrementChunk(chunkSize, numChunkElements);
             }
         }
     }
@@ -1843,6 +2256,71 @@ public:
     bool storeIntensiveQuantities() const
     { return enableIntensiveQuantityCache_ || enableThermodynamicHints_; }
 
+    /*!
+     * \brief Print the number of bytes which the data structures of the model require
+     *        for each degree of freedom.
+     *
+     * The sizes of the objects depend on the type tag, e.g. the extensions of the
+     * black-oil model which are disabled do not contribute to the size of the
+     * intensive and extensive quantities. The total per degree of freedom takes the
+     * caches which are enabled by the current run-time parameters and all blocks of the
+     * Jacobian matrix into account. Since the extensive quantities are only stored by
+     * the element contexts of the threads, they are reported separately.
+     */
+    void printMemoryFootprint(std::ostream& os) const
+    {
+        size_t intQuantsSize = sizeof(IntensiveQuantities);
+        size_t extQuantsSize = sizeof(ExtensiveQuantities);
+        size_t priVarsSize = sizeof(PrimaryVariables);
+        size_t eqVectorSize = sizeof(EqVector);
+
+        // determine the number of Jacobian blocks of each degree of freedom the same
+        // way as the linearizer and the largest number of faces of an element
+        size_t numDof = asImp_().numGridDof();
+        std::vector<std::set<unsigned> > neighbors(numDof);
+        size_t maxFaces = 0;
+        Stencil stencil(gridView_, asImp_().dofMapper());
+        for (const auto& elem : elements(gridView_)) {
+            stencil.update(elem);
+            maxFaces = std::max<size_t>(maxFaces, stencil.numInteriorFaces());
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                    neighbors[myIdx].insert(stencil.globalSpaceIndex(dofIdx));
+            }
+        }
+        size_t numBlocks = 0;
+        for (const auto& dofNeighbors : neighbors)
+            numBlocks += dofNeighbors.size();
+        double blocksPerDof = numDof > 0 ? static_cast<double>(numBlocks)/numDof : 0.0;
+
+        size_t solutionBytes = historySize*priVarsSize;
+        size_t intQuantsCacheBytes = storeIntensiveQuantities() ? historySize*intQuantsSize : 0;
+        size_t storageCacheBytes = enableStorageCache_ ? historySize*eqVectorSize : 0;
+        size_t blockBytes = numEq*numEq*sizeof(Scalar);
+        double jacobianBytes = blocksPerDof*blockBytes;
+        size_t extQuantsBytes = ThreadManager::maxThreads()*maxFaces*extQuantsSize;
+
+        os << "Memory footprint per degree of freedom:\n"
+           << "  primary variables:          " << priVarsSize << " bytes\n"
+           << "  intensive quantities:       " << intQuantsSize << " bytes\n"
+           << "  solutions:                  " << solutionBytes << " bytes ("
+           << historySize << " time levels)\n"
+           << "  intensive quantities cache: " << intQuantsCacheBytes << " bytes"
+           << (storeIntensiveQuantities() ? "\n" : " (disabled)\n")
+           << "  storage cache:              " << storageCacheBytes << " bytes"
+           << (enableStorageCache_ ? "\n" : " (disabled)\n")
+           << "  Jacobian blocks:            " << jacobianBytes << " bytes ("
+           << blocksPerDof << " blocks of " << blockBytes << " bytes)\n"
+           << "  total:                      "
+           << solutionBytes + intQuantsCacheBytes + storageCacheBytes + jacobianBytes
+           << " bytes\n"
+           << "Memory footprint of the element contexts:\n"
+           << "  extensive quantities:       " << extQuantsBytes << " bytes ("
+           << ThreadManager::maxThreads() << " thread(s), " << maxFaces << " faces of "
+           << extQuantsSize << " bytes)\n" << std::flush;
+    }
+
 #if HAVE_DUNE_FEM
     AdaptationManager& adaptationManager()
     {
@@ -1881,6 +2359,7 @@ protected:
                 storageCache_[timeIdx].resize(numDof);
             }
         }
+        storageCacheUpToDate_ = false;
 
         // allocate the intensive quantities cache
         if (storeIntensiveQuantities()) {
@@ -1892,6 +2371,64 @@ protected:
             }
         }
     }
+    void updateElementOrdering_()
+    {
+        elementOrdering_.clear();
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableElementReordering))
+            return;
+
+        // determine the element adjacency graph
+        size_t numElements = elementMapper_.size();
+        std::vector<std::vector<unsigned> > adjacency(numElements);
+        std::vector<ElementSeed> seeds(numElements);
+        ElementIterator elemIt = gridView_.template begin</*codim=*/0>();
+        const ElementIterator& elemEndIt = gridView_.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            unsigned elemIdx = elementMapper_.index(elem);
+            seeds[elemIdx] = elem.seed();
+
+            auto isIt = gridView_.ibegin(elem);
+            const auto& isEndIt = gridView_.iend(elem);
+            for (; isIt != isEndIt; ++isIt) {
+                if (isIt->neighbor())
+                    adjacency[elemIdx].push_back(elementMapper_.index(isIt->outside()));
+            }
+        }
+
+        const auto& ordering = reverseCuthillMcKee(adjacency);
+        elementOrdering_.resize(ordering.size());
+        for (unsigned i = 0; i < ordering.size(); ++i)
+            elementOrdering_[i] = seeds[ordering[i]];
+    }
+
+    // determine which element is responsible for each DOF (cf. dofOwner())
+    void updateDofOwners_()
+    {
+        const unsigned noOwner = std::numeric_limits<unsigned>::max();
+        dofOwner_.assign(asImp_().numGridDof(), noOwner);
+
+        // interior elements take precedence because only they are considered by the
+        // storage cache
+        std::vector<bool> interiorOwner(dofOwner_.size(), false);
+        ElementContext elemCtx(simulator_);
+        ElementIterator elemIt = gridView_.template begin</*codim=*/0>();
+        const ElementIterator& elemEndIt = gridView_.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            bool isInterior = elem.partitionType() == Dune::InteriorEntity;
+            unsigned elemIdx = elementMapper_.index(elem);
+            elemCtx.updatePrimaryStencil(elem);
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx) {
+                unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                if (dofOwner_[globalIdx] == noOwner || (isInterior && !interiorOwner[globalIdx])) {
+                    dofOwner_[globalIdx] = elemIdx;
+                    interiorOwner[globalIdx] = isInterior;
+                }
+            }
+        }
+    }
+
     template <class Context>
     void supplementInitialSolution_(PrimaryVariables& priVars OPM_UNUSED,
                                     const Context& context OPM_UNUSED,
@@ -1960,7 +2497,9 @@ protected:
     // cur is the current iterative solution, prev the converged
     // solution of the previous time step
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
-    mutable std::vector<bool> intensiveQuantityCacheUpToDate_[historySize];
+    // the flags are bytes instead of the bits of a std::vector<bool> because the
+    // entries of different degrees of freedom are written by different threads
+    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
 
     DiscreteFunctionSpace space_;
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
@@ -1978,11 +2517,23 @@ protected:
     std::vector<bool> isLocalDof_;
 
     mutable GlobalEqVector storageCache_[historySize];
+    bool storageCacheUpToDate_;
+    std::vector<unsigned> dofOwner_;
 
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+
+    // the solution before the previous one and the size of the time step which lead
+    // from it to the previous solution. these are only used by the solution predictor.
+    bool enableSolutionPredictor_;
+    SolutionVector predictorSolution_;
+    Scalar predictorTimeStepSize_;
+    // true if the current solution was extrapolated for the current time step
+    bool solutionPredicted_;
+
+    std::vector<ElementSeed> elementOrdering_;
 };
 } // namespace Opm
 
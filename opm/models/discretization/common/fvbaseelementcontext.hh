@@ -36,6 +36,7 @@
 #include <opm/material/common/Unused.hpp>
 
 #include <dune/common/fvector.hh>
+#include <dune/grid/common/gridenums.hh>
 
 #include <vector>
 
@@ -98,6 +99,7 @@ public:
         // remember the simulator object
         simulatorPtr_ = &simulator;
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
+        useStorageCache_ = enableStorageCache_;
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
     }
@@ -132,6 +134,7 @@ public:
     {
         // remember the current element
         elemPtr_ = &elem;
+        updateStorageCacheUse_();
 
         // update the stencil. the center gradients are quite expensive to calculate and
         // most models don't need them, so that we only do this if the model explicitly
@@ -153,6 +156,7 @@ public:
     {
         // remember the current element
         elemPtr_ = &elem;
+        updateStorageCacheUse_();
 
         // update the finite element geometry
         stencil_.updatePrimaryTopology(elem);
@@ -170,6 +174,7 @@ public:
     {
         // remember the current element
         elemPtr_ = &elem;
+        updateStorageCacheUse_();
 
         // update the finite element geometry
         stencil_.updateTopology(elem);
@@ -181,7 +186,7 @@ public:
      */
     void updateAllIntensiveQuantities()
     {
-        if (!enableStorageCache_) {
+        if (!useStorageCache_) {
             // if the storage cache is disabled, we need to calculate the storage term
             // from scratch, i.e. we need the intensive quantities of all of the history.
             for (unsigned timeIdx = 0; timeIdx < timeDiscHistorySize; ++ timeIdx)
@@ -212,6 +217,32 @@ public:
     void updatePrimaryIntensiveQuantities(unsigned timeIdx)
     { updateIntensiveQuantities_(timeIdx, numPrimaryDof(timeIdx)); }
 
+    /*!
+     * \brief Fill the model's intensive quantity cache for the primary degrees of
+     *        freedom which are owned by the current element.
+     *
+     * Degrees of freedom which are already cached or which are owned by a different
+     * element (cf. FvBaseDiscretization::dofOwner()) are skipped, so that a parallel
+     * sweep over the grid computes and writes each cache entry exactly once.
+     * Afterwards, the intensive quantities of the context are only valid for the
+     * degrees of freedom which have been computed by this call.
+     *
+     * \param timeIdx The index of the solution vector used by the time discretization.
+     */
+    void updatePrimaryIntensiveQuantitiesCache(unsigned timeIdx)
+    {
+        unsigned elemIdx = model().elementMapper().index(element());
+        size_t numDof = numPrimaryDof(timeIdx);
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
+            if (model().dofOwner(globalIdx) != elemIdx ||
+                model().cachedIntensiveQuantities(globalIdx, timeIdx))
+                continue;
+
+            updateDofIntensiveQuantities(dofIdx, timeIdx);
+        }
+    }
+
     /*!
      * \brief Compute the intensive quantities of a single sub-control volume of the
      *        current element for a single time index.
@@ -225,6 +256,39 @@ public:
     void updateIntensiveQuantities(const PrimaryVariables& priVars, unsigned dofIdx, unsigned timeIdx)
     { asImp_().updateSingleIntQuants_(priVars, dofIdx, timeIdx); }
 
+    /*!
+     * \brief Compute the intensive quantities of a single sub-control volume of the
+     *        current element for a single time index using the global solution.
+     *
+     * This is the same as updateIntensiveQuantities(timeIdx) for a single degree of
+     * freedom, i.e., the cache of the model is used and the thermodynamic hint is
+     * considered.
+     *
+     * \param dofIdx The local index in the current element of the sub-control volume
+     *               which should be updated.
+     * \param timeIdx The index of the solution vector used by the time discretization.
+     */
+    void updateDofIntensiveQuantities(unsigned dofIdx, unsigned timeIdx)
+    {
+        unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
+        const PrimaryVariables& dofSol = model().solution(timeIdx)[globalIdx];
+        dofVars_[dofIdx].priVars[timeIdx] = dofSol;
+
+        dofVars_[dofIdx].thermodynamicHint[timeIdx] =
+            model().thermodynamicHint(globalIdx, timeIdx);
+
+        const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
+        if (cachedIntQuants) {
+            dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
+        }
+        else {
+            updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
+            model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
+                                                    globalIdx,
+                                                    timeIdx);
+        }
+    }
+
     /*!
      * \brief Compute the extensive quantities of all sub-control volume
      *        faces of the current element for all time indices.
@@ -243,6 +307,23 @@ public:
     {
         gradientCalculator_.prepare(/*context=*/asImp_(), timeIdx);
 
+        asImp_().updateFocusedExtensiveQuantities(timeIdx);
+    }
+
+    /*!
+     * \brief Re-compute the extensive quantities of all sub-control volume faces of the
+     *        current element after the focus degree of freedom has been changed.
+     *
+     * In contrast to updateExtensiveQuantities(), the gradient calculator is not
+     * prepared again. Since this only depends on the geometry of the element, this
+     * method can be used if the extensive quantities have already been updated for
+     * the same element and time index using a different focus DOF.
+     *
+     * \param timeIdx The index of the solution vector used by the
+     *                time discretization.
+     */
+    void updateFocusedExtensiveQuantities(unsigned timeIdx)
+    {
         for (unsigned fluxIdx = 0; fluxIdx < numInteriorFaces(timeIdx); fluxIdx++) {
             extensiveQuantities_[fluxIdx].update(/*context=*/asImp_(),
                                                  /*localIndex=*/fluxIdx,
@@ -411,7 +492,7 @@ public:
 #ifndef NDEBUG
         assert(dofIdx < numDof(timeIdx));
 
-        if (enableStorageCache_ && timeIdx != 0 && problem().recycleFirstIterationStorage())
+        if (useStorageCache_ && timeIdx != 0 && model().recycleFirstIterationStorage())
             throw std::logic_error("If caching of the storage term is enabled, only the intensive quantities "
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
@@ -529,16 +610,20 @@ public:
      * \brief Returns true iff the cache for the storage term ought to be used for this context.
      *
      * If it is used, intensive quantities can only be accessed for the most recent time
-     * index. (time index 0.)
+     * index. (time index 0.) The storage cache only holds the storage terms of the
+     * interior elements, so it is never used for the other elements.
      */
     bool enableStorageCache() const
-    { return enableStorageCache_; }
+    { return useStorageCache_; }
 
     /*!
      * \brief Specifies if the cache for the storage term ought to be used for this context.
      */
     void setEnableStorageCache(bool yesno)
-    { enableStorageCache_ = yesno; }
+    {
+        enableStorageCache_ = yesno;
+        useStorageCache_ = yesno;
+    }
 
 private:
     Implementation& asImp_()
@@ -548,6 +633,10 @@ private:
     { return *static_cast<const Implementation*>(this); }
 
 protected:
+    // the storage cache only holds the storage terms of the interior elements
+    void updateStorageCacheUse_()
+    { useStorageCache_ = enableStorageCache_ && elemPtr_->partitionType() == Dune::InteriorEntity; }
+
     /*!
      * \brief Update the first 'n' intensive quantities objects from the primary variables.
      *
@@ -555,35 +644,15 @@ protected:
      */
     void updateIntensiveQuantities_(unsigned timeIdx, size_t numDof)
     {
-        // update the intensive quantities for the whole history
-        const SolutionVector& globalSol = model().solution(timeIdx);
-
         // update the non-gradient quantities
-        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++) {
-            unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
-            const PrimaryVariables& dofSol = globalSol[globalIdx];
-            dofVars_[dofIdx].priVars[timeIdx] = dofSol;
-
-            dofVars_[dofIdx].thermodynamicHint[timeIdx] =
-                model().thermodynamicHint(globalIdx, timeIdx);
-
-            const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
-            if (cachedIntQuants) {
-                dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
-            }
-            else {
-                updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
-                model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
-                                                        globalIdx,
-                                                        timeIdx);
-            }
-        }
+        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++)
+            updateDofIntensiveQuantities(dofIdx, timeIdx);
     }
 
     void updateSingleIntQuants_(const PrimaryVariables& priVars, unsigned dofIdx, unsigned timeIdx)
     {
 #ifndef NDEBUG
-        if (enableStorageCache_ && timeIdx != 0 && problem().recycleFirstIterationStorage())
+        if (useStorageCache_ && timeIdx != 0 && model().recycleFirstIterationStorage())
             throw std::logic_error("If caching of the storage term is enabled, only the intensive quantities "
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
@@ -608,6 +677,7 @@ protected:
     int stashedDofIdx_;
     int focusDofIdx_;
     bool enableStorageCache_;
+    bool useStorageCache_;
 };
 
 } // namespace Opm
@@ -35,15 +35,21 @@
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/profiler.hh>
 
 #include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/MathToolbox.hpp>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <type_traits>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <thread>
 #include <set>
@@ -78,6 +84,7 @@ class FvBaseLinearizer
     using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
     using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using LocalLinearizer = GetPropType<TypeTag, Properties::LocalLinearizer>;
 
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
@@ -92,6 +99,7 @@ class FvBaseLinearizer
     using Toolbox = MathToolbox<Evaluation>;
 
     using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
 
     using Vector = GlobalEqVector;
@@ -129,7 +137,23 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, UseColoredFiniteDifferences,
+                             "Calculate the Jacobian by perturbing structurally independent "
+                             "sets of degrees of freedom of the whole grid at once (requires "
+                             "finite differences and is only used if the focus time index is "
+                             "zero)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableLocalizedLinearization,
+                             "Only linearize the elements adjacent to degrees of freedom "
+                             "which changed since the last linearization (requires the ECFV "
+                             "discretization)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, LocalizedLinearizationTolerance,
+                             "The weighted change of a primary variable above which the "
+                             "adjacent elements are linearized again");
+        EWOMS_REGISTER_PARAM(TypeTag, int, LocalizedLinearizationFullInterval,
+                             "The number of Newton iterations after which all elements are "
+                             "linearized again if the linearization is localized");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -143,6 +167,11 @@ public:
     void init(Simulator& simulator)
     {
         simulatorPtr_ = &simulator;
+        if (useColoredFiniteDifferences_() && !std::is_same<Evaluation, Scalar>::value)
+            throw std::invalid_argument("Colored finite differences can only be used in "
+                                        "conjunction with the finite difference local "
+                                        "linearizer");
+
         eraseMatrix();
         auto it = elementCtx_.begin();
         const auto& endIt = elementCtx_.end();
@@ -162,6 +191,7 @@ public:
     void eraseMatrix()
     {
         jacobian_.reset();
+        lastLinearizedSolution_.resize(0);
     }
 
     /*!
@@ -190,6 +220,27 @@ public:
      * represented by the model object.
      */
     void linearizeDomain()
+    {
+        int succeeded = linearizeDomainLocally();
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalIssue("A process did not succeed in linearizing the system");
+    }
+
+    /*!
+     * \brief Linearize the part of the non-linear system of equations that is associated
+     *        with the spatial domain without agreeing on the success with the other
+     *        processes.
+     *
+     * This allows the caller to combine the outcome with a reduction which it needs to
+     * do anyway. If the linearization failed, the residual and the Jacobian matrix are
+     * undefined, but all processes can still take part in the collective operations
+     * which follow.
+     *
+     * \return true if the linearization succeeded on the current process
+     */
+    bool linearizeDomainLocally()
     {
         // we defer the initialization of the Jacobian matrix until here because the
         // auxiliary modules usually assume the problem, model and grid to be fully
@@ -197,29 +248,147 @@ public:
         if (!jacobian_)
             initFirstIteration_();
 
-        int succeeded;
         try {
             linearize_();
-            succeeded = 1;
+            return true;
         }
         catch (const std::exception& e)
         {
             std::cout << "rank " << simulator_().gridView().comm().rank()
                       << " caught an exception while linearizing:" << e.what()
                       << "\n"  << std::flush;
-            succeeded = 0;
         }
         catch (...)
         {
             std::cout << "rank " << simulator_().gridView().comm().rank()
                       << " caught an exception while linearizing"
                       << "\n"  << std::flush;
+        }
+        return false;
+    }
+
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution
+     *        without assembling its Jacobian matrix.
+     *
+     * This is considerably cheaper than linearizeDomain() if finite differences are
+     * used. With automatic differentiation, the derivatives of the intensive
+     * quantities are still computed, but the matrix is not touched. The residual of
+     * the auxiliary equations is not considered.
+     *
+     * \param dest The vector which receives the residual
+     */
+    void evaluateResidual(GlobalEqVector& dest)
+    {
+        if (!jacobian_)
+            initFirstIteration_();
+
+        int succeeded;
+        try {
+            prepareLinearization_(/*updateIntensiveQuantities=*/true);
+            evalResidual_(dest);
+
+            // constraint degrees of freedom do not exhibit a residual
+            if (enableConstraints_()) {
+                for (const auto& constraint : constraintsMap_)
+                    dest[constraint.first] = 0.0;
+            }
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
             succeeded = 0;
         }
         succeeded = gridView_().comm().min(succeeded);
 
         if (!succeeded)
-            throw NumericalIssue("A process did not succeed in linearizing the system");
+            throw NumericalIssue("A process did not succeed in evaluating the residual");
+
+        Profiler::addToCounter("residual evaluations", 1.0);
+    }
+
+    /*!
+     * \brief Linearize the residual of a subdomain of the grid with respect to the
+     *        primary variables of the subdomain.
+     *
+     * The subdomain is given by a list of elements. The degrees of freedom which are
+     * not part of the subdomain are considered to be fixed, i.e., the derivatives with
+     * respect to them are not computed. The global linearization is not touched.
+     *
+     * \param elements The seeds of the elements of the subdomain
+     * \param localIndex A function which maps the global index of a degree of freedom
+     *                   to its index within the subdomain or returns a negative value
+     *                   if it is not part of the subdomain
+     * \param subdomainJacobian The matrix which receives the Jacobian of the subdomain.
+     *                          Its sparsity pattern must be set up by the caller.
+     * \param subdomainResidual The vector which receives the residual of the subdomain
+     */
+    template <class LocalIndexFn, class SubdomainMatrix, class SubdomainVector>
+    void linearizeSubdomain(const std::vector<ElementSeed>& elements,
+                            const LocalIndexFn& localIndex,
+                            SubdomainMatrix& subdomainJacobian,
+                            SubdomainVector& subdomainResidual)
+    {
+        if (!jacobian_)
+            initFirstIteration_();
+
+        prepareLinearization_(/*updateIntensiveQuantities=*/false);
+
+        subdomainJacobian = 0.0;
+        subdomainResidual = 0.0;
+
+        const size_t numElements = elements.size();
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<size_t> nextIdx(0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext *elementCtx = elementCtx_[threadId];
+            auto& localLinearizer = model_().localLinearizer(threadId);
+            try {
+                for (size_t idx = nextIdx++; idx < numElements; idx = nextIdx++) {
+                    const auto& elem = gridView_().grid().entity(elements[idx]);
+                    localLinearizer.linearize(*elementCtx, elem);
+
+                    if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+                        globalMatrixMutex_.lock();
+
+                    size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+                        int locI = localIndex(elementCtx->globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0));
+                        if (locI < 0)
+                            continue;
+
+                        subdomainResidual[locI] += localLinearizer.residual(primaryDofIdx);
+                        for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
+                            int locJ = localIndex(elementCtx->globalSpaceIndex(dofIdx, /*timeIdx=*/0));
+                            if (locJ < 0)
+                                continue;
+
+                            subdomainJacobian[locJ][locI] += localLinearizer.jacobian(dofIdx, primaryDofIdx);
+                        }
+                    }
+
+                    if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+                        globalMatrixMutex_.unlock();
+                }
+            }
+            // see linearize_() for the rationale of bridging exceptions this way
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                nextIdx = numElements;
+            }
+        }  // parallel block
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
     }
 
     void finalize()
@@ -274,6 +443,22 @@ public:
     GlobalEqVector& residual()
     { return residual_; }
 
+    /*!
+     * \brief Returns true if the last linearization only re-evaluated the elements
+     *        whose stencil has changed.
+     *
+     * The entries of the residual which belong to the remaining elements are then
+     * kept from a previous linearization, i.e., they may be slightly stale.
+     */
+    bool linearizationLocalized() const
+    { return localizedPass_; }
+
+    /*!
+     * \brief Make sure that the next linearization considers all elements.
+     */
+    void requireFullLinearization()
+    { fullLinearizationRequired_ = true; }
+
     void setLinearizationType(LinearizationType linearizationType){
         linearizationType_ = linearizationType;
     };
@@ -368,6 +553,89 @@ private:
 
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern);
+
+        if (useColoredFiniteDifferences_())
+            updateColoring_(sparsityPattern);
+    }
+
+    // compute a distance-2 coloring of the degrees of freedom of the grid, i.e., no two
+    // degrees of freedom of the same color contribute to the residual of the same degree
+    // of freedom. This assumes that the sparsity pattern is structurally symmetric which
+    // is the case for all finite volume stencils.
+    template <class SparsityPattern>
+    void updateColoring_(const SparsityPattern& sparsityPattern)
+    {
+        size_t numGridDof = model_().numGridDof();
+
+        // the residuals of the auxiliary equations are not calculated by the elements,
+        // so only the neighbors which are grid DOFs are relevant
+        fdNeighbors_.resize(numGridDof);
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            fdNeighbors_[dofIdx].clear();
+            for (unsigned neighborIdx : sparsityPattern[dofIdx])
+                if (neighborIdx < numGridDof)
+                    fdNeighbors_[dofIdx].push_back(neighborIdx);
+        }
+
+        // greedy coloring
+        const unsigned uncolored = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> dofColor(numGridDof, uncolored);
+        std::vector<unsigned> forbiddenBy(numGridDof, uncolored);
+        fdColors_.clear();
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            for (unsigned rowIdx : fdNeighbors_[dofIdx]) {
+                for (unsigned otherIdx : fdNeighbors_[rowIdx]) {
+                    unsigned otherColor = dofColor[otherIdx];
+                    if (otherColor != uncolored)
+                        forbiddenBy[otherColor] = dofIdx;
+                }
+            }
+
+            unsigned color = 0;
+            while (color < fdColors_.size() && forbiddenBy[color] == dofIdx)
+                ++color;
+            if (color == fdColors_.size())
+                fdColors_.emplace_back();
+
+            dofColor[dofIdx] = color;
+            fdColors_[color].push_back(dofIdx);
+        }
+
+        // the elements whose residual depends on a degree of freedom of a given color,
+        // and the offset of each element's local residual in fdElemResidual_. only these
+        // elements need to be evaluated again if the color is perturbed.
+        Stencil stencil(gridView_(), model_().dofMapper());
+        fdColorElements_.clear();
+        fdColorElements_.resize(fdColors_.size());
+        std::vector<int> lastElemOfColor(fdColors_.size(), -1);
+        fdElemOffset_.assign(gridView_().size(/*codim=*/0), 0);
+        size_t numLocalResiduals = 0;
+        ElementIterator elemIt = gridView_().template begin<0>();
+        const ElementIterator elemEndIt = gridView_().template end<0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+            int elemIdx = static_cast<int>(elementMapper_().index(elem));
+            fdElemOffset_[elemIdx] = numLocalResiduals;
+            numLocalResiduals += stencil.numPrimaryDof();
+
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                unsigned globalIdx = stencil.globalSpaceIndex(dofIdx);
+                if (globalIdx >= numGridDof)
+                    continue;
+
+                unsigned color = dofColor[globalIdx];
+                if (lastElemOfColor[color] == elemIdx)
+                    continue;
+
+                lastElemOfColor[color] = elemIdx;
+                fdColorElements_[color].push_back(elem.seed());
+            }
+        }
+        fdElemResidual_.resize(numLocalResiduals);
     }
 
     // reset the global linear system of equations.
@@ -424,19 +692,61 @@ private:
         }
     }
 
-    // linearize the whole system
-    void linearize_()
+    // before the first iteration of each time step, we need to update the constraints.
+    // (i.e., we assume that constraints can be time dependent, but they can't depend on
+    // the solution.) the storage terms of the previous time step are then computed
+    // from the constrained solution in a single sweep over the grid instead of once
+    // for each element adjacent to a degree of freedom. if the whole grid is going to
+    // be traversed, the intensive quantities of the current solution are also
+    // computed in one sweep so that the elements only need to copy them.
+    void prepareLinearization_(bool updateIntensiveQuantities)
     {
-        resetSystem_();
-
-        // before the first iteration of each time step, we need to update the
-        // constraints. (i.e., we assume that constraints can be time dependent, but they
-        // can't depend on the solution.)
-        if (model_().newtonMethod().numIterations() == 0)
+        if (model_().newtonMethod().numIterations() == 0 && !constraintsMapUpToDate_) {
             updateConstraintsMap_();
+            constraintsMapUpToDate_ = true;
+        }
 
         applyConstraintsToSolution_();
 
+        if (model_().enableStorageCache() && !model_().storageCacheUpToDate())
+            model_().updateStorageCache();
+
+        if (updateIntensiveQuantities)
+            model_().updateIntensiveQuantitiesCache(/*timeIdx=*/0);
+    }
+
+    // linearize the whole system
+    void linearize_()
+    {
+        // if only some elements are linearized, the contributions of the remaining ones
+        // are kept from the previous linearization
+        localizedPass_ = updateActiveElements_();
+        if (localizedPass_)
+            residual_ = localizedResidual_;
+        else
+            resetSystem_();
+
+        prepareLinearization_(/*updateIntensiveQuantities=*/!localizedPass_);
+
+        // the constraints are updated again at the first iteration of the next time
+        // step
+        constraintsMapUpToDate_ = false;
+
+        // the colored finite differences perturb the current solution, so other focus
+        // time indices are left to the element-wise linearization
+        if (useColoredFiniteDifferences_() && linearizationType_.time == 0) {
+            linearizeColored_();
+            applyConstraintsToLinearization_();
+            return;
+        }
+
+        if (!model_().elementOrdering().empty()) {
+            linearizeOrdered_();
+            applyConstraintsToLinearization_();
+            saveLocalizedResidual_();
+            return;
+        }
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -448,12 +758,15 @@ private:
 
         // relinearize the elements...
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        const auto profilerPath = Profiler::currentPath();
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
+            ProfilerRegion profilerRegion("linearize elements", profilerPath);
             ElementIterator elemIt = threadedElemIt.beginParallel();
             ElementIterator nextElemIt = elemIt;
+            unsigned numLinearized = 0;
             try {
                 for (; !threadedElemIt.isFinished(elemIt); elemIt = nextElemIt) {
                     // give the model and the problem a chance to prefetch the data required
@@ -473,7 +786,11 @@ private:
                     if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                         continue;
 
+                    if (localizedPass_ && !activeElements_[elementMapper_().index(elem)])
+                        continue;
+
                     linearizeElement_(elem);
+                    ++ numLinearized;
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -490,6 +807,7 @@ private:
                 exceptionPtr = std::current_exception();
                 threadedElemIt.setFinished();
             }
+            Profiler::addToCounter("linearized elements", numLinearized);
         }  // parallel block
 
         // after reduction from the parallel block, exceptionPtr will point to
@@ -500,6 +818,77 @@ private:
         }
 
         applyConstraintsToLinearization_();
+        saveLocalizedResidual_();
+    }
+
+    // linearize the elements in the order prescribed by the model (e.g., reverse
+    // Cuthill-McKee) instead of the order of the grid's element iterator
+    void linearizeOrdered_()
+    {
+        const auto& ordering = model_().elementOrdering();
+        const size_t numElements = ordering.size();
+
+        // the threads take contiguous chunks of the ordering, so the elements handled
+        // by a thread are neighbors and its accesses to the solution and to the
+        // Jacobian matrix stay within a narrow band. The chunks are handed out on
+        // demand to balance the load if the elements are not equally expensive.
+        const size_t chunkSize = std::max<size_t>(1, numElements/(8*ThreadManager::maxThreads()));
+        std::atomic<size_t> nextChunkBegin(0);
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> failed(false);
+
+        const auto profilerPath = Profiler::currentPath();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ProfilerRegion profilerRegion("linearize elements", profilerPath);
+            unsigned numLinearized = 0;
+            try {
+                while (!failed) {
+                    size_t beginIdx = nextChunkBegin.fetch_add(chunkSize);
+                    if (beginIdx >= numElements)
+                        break;
+                    size_t endIdx = std::min(beginIdx + chunkSize, numElements);
+
+                    for (size_t idx = beginIdx; idx < endIdx && !failed; ++idx) {
+                        // give the model and the problem a chance to prefetch the data
+                        // required to linearize the next element of the chunk
+                        if (idx + 1 < endIdx) {
+                            const auto& nextElem = gridView_().grid().entity(ordering[idx + 1]);
+                            if (linearizeNonLocalElements
+                                || nextElem.partitionType() == Dune::InteriorEntity)
+                            {
+                                model_().prefetch(nextElem);
+                                problem_().prefetch(nextElem);
+                            }
+                        }
+
+                        const auto& elem = gridView_().grid().entity(ordering[idx]);
+                        if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                            continue;
+
+                        if (localizedPass_ && !activeElements_[elementMapper_().index(elem)])
+                            continue;
+
+                        linearizeElement_(elem);
+                        ++ numLinearized;
+                    }
+                }
+            }
+            // see linearize_() for the rationale of bridging exceptions this way
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                failed = true;
+            }
+            Profiler::addToCounter("linearized elements", numLinearized);
+        }  // parallel block
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
     }
 
     // linearize an element in the interior of the process' grid partition
@@ -514,6 +903,7 @@ private:
         localLinearizer.linearize(*elementCtx, elem);
 
         // update the right hand side and the Jacobian matrix
+        ProfilerRegion profilerRegion("scatter", /*traced=*/false);
         if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
             globalMatrixMutex_.lock();
 
@@ -521,6 +911,18 @@ private:
         for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
             unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
 
+            // with ECFV, the residual and the column of the Jacobian matrix of a degree of
+            // freedom are exclusively determined by its element. thus, the values of the
+            // previous linearization can simply be overwritten by a localized pass.
+            if (localizedPass_) {
+                residual_[globI] = localLinearizer.residual(primaryDofIdx);
+                for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
+                    unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+                    jacobian_->setBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
+                }
+                continue;
+            }
+
             // update the right hand side
             residual_[globI] += localLinearizer.residual(primaryDofIdx);
 
@@ -536,6 +938,258 @@ private:
             globalMatrixMutex_.unlock();
     }
 
+    // linearize the whole grid using forward differences, where all degrees of freedom
+    // of a given color are perturbed at once. after the unperturbed residual of the
+    // whole grid is known, only the elements adjacent to the perturbed color need to be
+    // evaluated again.
+    void linearizeColored_()
+    {
+        // rejected by init() for automatic differentiation, which lacks the perturbation
+        // of the finite difference local linearizer
+        if constexpr (std::is_same<Evaluation, Scalar>::value) {
+            auto& model = model_();
+            auto& solution = model.solution(/*timeIdx=*/0);
+
+            // the unperturbed residual
+            evalResidual_(residual_, /*storeElemResiduals=*/true);
+
+            fdResidual_.resize(residual_.size());
+            MatrixBlock block;
+            for (unsigned color = 0; color < fdColors_.size(); ++color) {
+                const auto& colorDofs = fdColors_[color];
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                    // perturb the primary variable of all degrees of freedom of the color
+                    for (unsigned dofIdx : colorDofs) {
+                        solution[dofIdx][pvIdx] += numericEpsilon_(dofIdx, pvIdx);
+                        model.setIntensiveQuantitiesCacheEntryValidity(dofIdx, /*timeIdx=*/0, false);
+                        for (unsigned rowIdx : fdNeighbors_[dofIdx])
+                            fdResidual_[rowIdx] = 0.0;
+                    }
+
+                    evalColorResidualChange_(color);
+
+                    // recover the Jacobian entries and restore the solution. since the
+                    // coloring ensures that each residual only depends on a single
+                    // perturbed degree of freedom, all its changes can be attributed to
+                    // this one.
+                    for (unsigned dofIdx : colorDofs) {
+                        Scalar eps = numericEpsilon_(dofIdx, pvIdx);
+                        for (unsigned rowIdx : fdNeighbors_[dofIdx]) {
+                            block = 0.0;
+                            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                                block[eqIdx][pvIdx] = fdResidual_[rowIdx][eqIdx]/eps;
+                            jacobian_->addToBlock(rowIdx, dofIdx, block);
+                        }
+
+                        solution[dofIdx][pvIdx] -= eps;
+                        model.setIntensiveQuantitiesCacheEntryValidity(dofIdx, /*timeIdx=*/0, false);
+                    }
+                }
+            }
+        }
+    }
+
+    // evaluate the residual of the whole grid for the current solution. if requested,
+    // the local residual of each element is remembered for the colored finite
+    // differences.
+    void evalResidual_(GlobalEqVector& dest, bool storeElemResiduals = false)
+    {
+        dest = 0.0;
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext *elementCtx = elementCtx_[threadId];
+            auto& localResidual = model_().localResidual(threadId);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    elementCtx->updateAll(elem);
+                    localResidual.eval(*elementCtx);
+
+                    if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+                        globalMatrixMutex_.lock();
+
+                    size_t offset = storeElemResiduals ? fdElemOffset_[elementMapper_().index(elem)] : 0;
+                    size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+                        unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+                        VectorBlock elemResidual;
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            elemResidual[eqIdx] = scalarValue(localResidual.residual(primaryDofIdx)[eqIdx]);
+                        dest[globI] += elemResidual;
+                        if (storeElemResiduals)
+                            fdElemResidual_[offset + primaryDofIdx] = elemResidual;
+                    }
+
+                    if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+                        globalMatrixMutex_.unlock();
+                }
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // add the change of the local residuals of the elements adjacent to a perturbed
+    // color to fdResidual_
+    void evalColorResidualChange_(unsigned color)
+    {
+        const auto& colorElements = fdColorElements_[color];
+        const size_t numElements = colorElements.size();
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<size_t> nextIdx(0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext *elementCtx = elementCtx_[threadId];
+            auto& localResidual = model_().localResidual(threadId);
+            try {
+                for (size_t idx = nextIdx++; idx < numElements; idx = nextIdx++) {
+                    const auto& elem = gridView_().grid().entity(colorElements[idx]);
+                    elementCtx->updateAll(elem);
+                    localResidual.eval(*elementCtx);
+
+                    if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+                        globalMatrixMutex_.lock();
+
+                    size_t offset = fdElemOffset_[elementMapper_().index(elem)];
+                    size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+                        unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+                        const auto& elemResidual = fdElemResidual_[offset + primaryDofIdx];
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            fdResidual_[globI][eqIdx] +=
+                                scalarValue(localResidual.residual(primaryDofIdx)[eqIdx])
+                                - elemResidual[eqIdx];
+                    }
+
+                    if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+                        globalMatrixMutex_.unlock();
+                }
+            }
+            // see linearize_() for the rationale of bridging exceptions this way
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                nextIdx = numElements;
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // the perturbation of a primary variable used by the colored finite differences.
+    // this is the same as the one used by the finite difference local linearizer.
+    Scalar numericEpsilon_(unsigned globalIdx, unsigned pvIdx) const
+    {
+        Scalar pvWeight = model_().primaryVarWeight(globalIdx, pvIdx);
+        assert(pvWeight > 0 && std::isfinite(pvWeight));
+
+        return LocalLinearizer::baseEpsilon()/pvWeight;
+    }
+
+    static bool useColoredFiniteDifferences_()
+    { return EWOMS_GET_PARAM(TypeTag, bool, UseColoredFiniteDifferences); }
+
+    static bool enableLocalizedLinearization_()
+    { return EWOMS_GET_PARAM(TypeTag, bool, EnableLocalizedLinearization); }
+
+    // returns true if the contributions of some elements can be kept from the previous
+    // linearization. this is only possible for ECFV because the other discretizations
+    // accumulate the residual of a degree of freedom from several elements. auxiliary
+    // modules are not considered because they add to the linearization of the grid.
+    bool localizedLinearizationApplicable_() const
+    {
+        return enableLocalizedLinearization_()
+            && std::is_same<Discretization, EcfvDiscretization<TypeTag>>::value
+            && !useColoredFiniteDifferences_()
+            && model_().numAuxiliaryModules() == 0;
+    }
+
+    // determine the elements which need to be linearized by a localized pass. returns
+    // false if all elements must be linearized.
+    bool updateActiveElements_()
+    {
+        if (!localizedLinearizationApplicable_())
+            return false;
+
+        const auto& model = model_();
+        const auto& solution = model.solution(/*timeIdx=*/0);
+        size_t numGridDof = model.numGridDof();
+
+        // all elements are linearized at the beginning of each time step and
+        // periodically afterwards to limit the accumulation of small changes which are
+        // below the tolerance
+        int iterIdx = model.newtonMethod().numIterations();
+        int fullInterval = EWOMS_GET_PARAM(TypeTag, int, LocalizedLinearizationFullInterval);
+        if (iterIdx == 0
+            || fullLinearizationRequired_
+            || (fullInterval > 0 && iterIdx % fullInterval == 0)
+            || lastLinearizedSolution_.size() != numGridDof
+            || localizedResidual_.size() != residual_.size())
+        {
+            fullLinearizationRequired_ = false;
+            lastLinearizedSolution_.resize(numGridDof);
+            for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx)
+                lastLinearizedSolution_[dofIdx] = solution[dofIdx];
+            return false;
+        }
+
+        // an element needs to be linearized if a degree of freedom of its stencil has
+        // changed. since the sparsity pattern is structurally symmetric, these are the
+        // neighbors of the changed degrees of freedom in the Jacobian matrix.
+        const Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LocalizedLinearizationTolerance);
+        const auto& matrix = jacobian_->istlMatrix();
+        activeElements_.assign(numGridDof, false);
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            bool changed = false;
+            for (unsigned pvIdx = 0; pvIdx < numEq && !changed; ++pvIdx) {
+                Scalar delta = std::abs(solution[dofIdx][pvIdx] - lastLinearizedSolution_[dofIdx][pvIdx]);
+                changed = delta*model.primaryVarWeight(dofIdx, pvIdx) > tolerance;
+            }
+
+            if (!changed)
+                continue;
+
+            lastLinearizedSolution_[dofIdx] = solution[dofIdx];
+            const auto& row = matrix[dofIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                activeElements_[colIt.index()] = true;
+        }
+
+        return true;
+    }
+
+    // the residual is modified by the Newton method (e.g., by the synchronization
+    // of the overlap), so the one of the last linearization needs to be kept separately
+    void saveLocalizedResidual_()
+    {
+        if (localizedLinearizationApplicable_())
+            localizedResidual_ = residual_;
+    }
+
     // apply the constraints to the solution. (i.e., the solution of constraint degrees
     // of freedom is set to the value of the constraint.)
     void applyConstraintsToSolution_()
@@ -585,6 +1239,7 @@ private:
     // The constraint equations (only non-empty if the
     // EnableConstraints property is true)
     std::map<unsigned, Constraints> constraintsMap_;
+    bool constraintsMapUpToDate_ = false;
 
     // the jacobian matrix
     std::unique_ptr<SparseMatrixAdapter> jacobian_;
@@ -592,6 +1247,26 @@ private:
     // the right-hand side
     GlobalEqVector residual_;
 
+    // the degrees of freedom of each color, the neighbors of each degree of freedom, the
+    // elements adjacent to each color, the unperturbed local residuals of the elements
+    // and the change of the residual caused by a perturbation (only used for colored
+    // finite differences)
+    std::vector<std::vector<unsigned>> fdColors_;
+    std::vector<std::vector<unsigned>> fdNeighbors_;
+    std::vector<std::vector<ElementSeed>> fdColorElements_;
+    std::vector<size_t> fdElemOffset_;
+    std::vector<VectorBlock> fdElemResidual_;
+    GlobalEqVector fdResidual_;
+
+    // the solution at which the elements were last linearized, the elements which need
+    // to be linearized by the current pass and the residual of the last linearization
+    // (only used for the localized linearization)
+    SolutionVector lastLinearizedSolution_;
+    std::vector<bool> activeElements_;
+    GlobalEqVector localizedResidual_;
+    bool localizedPass_ = false;
+    bool fullLinearizationRequired_ = false;
+
     LinearizationType linearizationType_;
 
     std::mutex globalMatrixMutex_;
@@ -537,9 +537,10 @@ protected:
                 const auto& model = elemCtx.model();
                 unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
                 if (model.newtonMethod().numIterations() == 0 &&
+                    !model.storageCacheUpToDate() &&
                     !elemCtx.haveStashedIntensiveQuantities())
                 {
-                    if (!elemCtx.problem().recycleFirstIterationStorage()) {
+                    if (!model.recycleFirstIterationStorage()) {
                         // we re-calculate the storage term for the solution of the
                         // previous time step from scratch instead of using the one of
                         // the first iteration of the current time step.
@@ -564,9 +565,9 @@ protected:
                     model.updateCachedStorage(globalDofIdx, /*timeIdx=*/1, tmp2);
                 }
                 else {
-                    // if the mass storage at the beginning of the time step is not cached,
                     // if the storage term is cached and we're not looking at the first
-                    // iteration of the time step, we take the cached data.
+                    // iteration of the time step or the cache has already been filled for
+                    // the whole grid, we take the cached data.
                     tmp2 = model.cachedStorage(globalDofIdx, /*timeIdx=*/1);
                     Valgrind::CheckDefined(tmp2);
                 }
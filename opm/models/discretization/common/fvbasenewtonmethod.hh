@@ -31,13 +31,30 @@
 #include "fvbasenewtonconvergencewriter.hh"
 
 #include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/utils/cuthillmckee.hh>
 #include <opm/models/utils/propertysystem.hh>
 
+#include <opm/material/common/Exceptions.hpp>
+
+#include <dune/common/version.hh>
+#include <dune/istl/matrixindexset.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
 namespace Opm {
 
 template <class TypeTag>
 class FvBaseNewtonMethod;
 
+template <class TypeTag>
+class EcfvDiscretization;
+
 template <class TypeTag>
 class FvBaseNewtonConvergenceWriter;
 } // namespace Opm
@@ -54,6 +71,19 @@ struct FvBaseNewtonMethod { using InheritsFrom = std::tuple<NewtonMethod>; };
 template<class TypeTag, class MyTypeTag>
 struct DiscNewtonMethod { using type = UndefinedProperty; };
 
+//! Specify whether non-linear problems on subdomains of the grid should be solved
+//! before each iteration of the Newton method
+template<class TypeTag, class MyTypeTag>
+struct NewtonEnableDomainDecomposition { using type = UndefinedProperty; };
+
+//! The number of subdomains into which the grid of each process is divided
+template<class TypeTag, class MyTypeTag>
+struct NewtonNumSubdomains { using type = UndefinedProperty; };
+
+//! The maximum number of Newton iterations done on a subdomain
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxSubdomainIterations { using type = UndefinedProperty; };
+
 // set default values
 template<class TypeTag>
 struct DiscNewtonMethod<TypeTag, TTag::FvBaseNewtonMethod>
@@ -67,6 +97,13 @@ template<class TypeTag>
 struct NewtonConvergenceWriter<TypeTag, TTag::FvBaseNewtonMethod>
 { using type = FvBaseNewtonConvergenceWriter<TypeTag>; };
 
+template<class TypeTag>
+struct NewtonEnableDomainDecomposition<TypeTag, TTag::FvBaseNewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonNumSubdomains<TypeTag, TTag::FvBaseNewtonMethod> { static constexpr int value = 16; };
+template<class TypeTag>
+struct NewtonMaxSubdomainIterations<TypeTag, TTag::FvBaseNewtonMethod> { static constexpr int value = 5; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -78,6 +115,14 @@ namespace Opm {
  *
  * This class is sufficient for most models which use an Element or a
  * Vertex Centered Finite Volume discretization.
+ *
+ * For the element centered finite volume discretization, the Newton method can
+ * optionally be preconditioned by a non-linear domain decomposition: Before each
+ * global iteration, the grid of each process is divided into subdomains and the
+ * non-linear problem of each subdomain is solved by a few local Newton iterations
+ * while the primary variables outside of the subdomain are kept fixed. The subdomains
+ * are visited one after another (i.e., this is a multiplicative Schwarz method) and
+ * are contiguous chunks of the reverse Cuthill-McKee ordering of the elements.
  */
 template <class TypeTag>
 class FvBaseNewtonMethod : public NewtonMethod<TypeTag>
@@ -93,16 +138,108 @@ class FvBaseNewtonMethod : public NewtonMethod<TypeTag>
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+    using Discretization = GetPropType<TypeTag, Properties::Discretization>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+
+    using SubdomainMatrix = typename SparseMatrixAdapter::IstlMatrix;
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
 
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
 
 public:
     FvBaseNewtonMethod(Simulator& simulator)
         : ParentType(simulator)
     { }
 
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonEnableDomainDecomposition,
+                             "Solve the non-linear problems of subdomains of the grid "
+                             "before each Newton iteration (requires the ECFV "
+                             "discretization)");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonNumSubdomains,
+                             "The number of subdomains into which the grid of each "
+                             "process is divided by the domain decomposition");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonMaxSubdomainIterations,
+                             "The maximum number of Newton iterations done on each "
+                             "subdomain by the domain decomposition");
+    }
+
+    /*!
+     * \copydoc NewtonMethod::converged()
+     *
+     * If the last linearization was localized, the residual of the elements which
+     * were skipped may be stale, so convergence is only accepted after a linearization
+     * of all elements.
+     */
+    bool converged() const
+    { return ParentType::converged() && !model_().linearizer().linearizationLocalized(); }
+
+    /*!
+     * \copydoc NewtonMethod::eraseMatrix()
+     */
+    void eraseMatrix()
+    {
+        ParentType::eraseMatrix();
+
+        // the subdomains are determined again at the next iteration
+        dofSubdomain_.clear();
+        subdomainError_.clear();
+    }
+
 protected:
     friend class NewtonMethod<TypeTag>;
 
+    /*!
+     * \brief Solve the non-linear problems of the subdomains of the process' grid.
+     *
+     * This is only done if the NewtonEnableDomainDecomposition parameter is set. If the
+     * discretization is not ECFV or if the model features auxiliary equations, nothing
+     * is done because the residual of a degree of freedom is then not determined by the
+     * elements of its subdomain alone.
+     *
+     * After the first iteration of a time step, the subdomains whose error in the last
+     * global residual is below the tolerance are skipped, and nothing is done at all
+     * once the global error is below the tolerance.
+     *
+     * \param nextSolution The solution which is to be improved
+     */
+    void solveSubdomains_(SolutionVector& nextSolution)
+    {
+        if (!domainDecompositionEnabled_())
+            return;
+
+        if (dofSubdomain_.size() != model_().numGridDof())
+            updateSubdomains_();
+
+        const bool haveLastErrors =
+            this->numIterations() > 0 && subdomainError_.size() == subdomainDofs_.size();
+        if (haveLastErrors && ParentType::converged())
+            return;
+
+        int numIterations = 0;
+        for (unsigned subdomainIdx = 0; subdomainIdx < subdomainDofs_.size(); ++subdomainIdx) {
+            if (haveLastErrors && subdomainError_[subdomainIdx] <= this->tolerance())
+                continue;
+
+            numIterations += solveSubdomain_(subdomainIdx, nextSolution);
+        }
+
+        // the solution of the degrees of freedom in the overlap may have changed
+        model_().syncOverlap();
+
+        numIterations = this->simulator_.gridView().comm().sum(numIterations);
+        Profiler::addToCounter("subdomain iterations", numIterations);
+        this->endIterMsg() << ", subdomain iterations: " << numIterations;
+    }
+
     /*!
      * \brief Update the current solution with a delta vector.
      *
@@ -147,6 +284,273 @@ protected:
         ParentType::beginIteration_();
     }
 
+    /*!
+     * \copydoc NewtonMethod::preSolve_
+     *
+     * If the error of a localized linearization is below the tolerance, the next
+     * linearization is done for all elements so that convergence can be verified. If
+     * the domain decomposition is used, the error of each subdomain is recorded so that
+     * the next sweep can skip the subdomains which are already converged.
+     */
+    void preSolve_(const SolutionVector& currentSolution,
+                   const GlobalEqVector& currentResidual)
+    {
+        ParentType::preSolve_(currentSolution, currentResidual);
+
+        auto& linearizer = model_().linearizer();
+        if (linearizer.linearizationLocalized() && ParentType::converged())
+            linearizer.requireFullLinearization();
+
+        if (domainDecompositionEnabled_() && dofSubdomain_.size() == model_().numGridDof())
+            updateSubdomainErrors_(currentResidual);
+    }
+
+    bool domainDecompositionEnabled_() const
+    {
+        return EWOMS_GET_PARAM(TypeTag, bool, NewtonEnableDomainDecomposition)
+            && std::is_same<Discretization, EcfvDiscretization<TypeTag>>::value
+            && model_().numAuxiliaryModules() == 0;
+    }
+
+    // compute the weighted maximum error of each subdomain in the global residual.
+    // the residual of the constraint degrees of freedom is zero.
+    void updateSubdomainErrors_(const GlobalEqVector& residual)
+    {
+        subdomainError_.assign(subdomainDofs_.size(), 0.0);
+        for (unsigned subdomainIdx = 0; subdomainIdx < subdomainDofs_.size(); ++subdomainIdx) {
+            Scalar& error = subdomainError_[subdomainIdx];
+            for (unsigned globalIdx : subdomainDofs_[subdomainIdx]) {
+                const auto& weights = this->errorWeights_[globalIdx];
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    error = std::max<Scalar>(error, std::abs(residual[globalIdx][eqIdx]*weights[eqIdx]));
+            }
+        }
+    }
+
+    // run the Newton method on a single subdomain and return the number of iterations.
+    // if the error of the subdomain is not reduced, its solution is reset.
+    int solveSubdomain_(unsigned subdomainIdx, SolutionVector& solution)
+    {
+        const auto& dofs = subdomainDofs_[subdomainIdx];
+        auto& matrix = subdomainMatrices_[subdomainIdx];
+        auto& linearizer = model_().linearizer();
+        const auto& constraintsMap = linearizer.constraintsMap();
+        const bool checkConstraints = this->enableConstraints_() && !constraintsMap.empty();
+        const int maxIterations = EWOMS_GET_PARAM(TypeTag, int, NewtonMaxSubdomainIterations);
+
+        size_t numDof = dofs.size();
+        subdomainResidual_.resize(numDof);
+        subdomainUpdate_.resize(numDof);
+        savedSolution_.resize(numDof);
+        for (unsigned locIdx = 0; locIdx < numDof; ++locIdx)
+            savedSolution_[locIdx] = solution[dofs[locIdx]];
+
+        auto localIndex = [this, subdomainIdx](unsigned globalIdx) {
+            return dofSubdomain_[globalIdx] == static_cast<int>(subdomainIdx)
+                ? static_cast<int>(dofLocalIdx_[globalIdx])
+                : -1;
+        };
+
+        int iterIdx = 0;
+        Scalar initialError = 0.0;
+        bool succeeded = true;
+        try {
+            for (; ; ++iterIdx) {
+                linearizer.linearizeSubdomain(subdomainElements_[subdomainIdx],
+                                              localIndex,
+                                              matrix,
+                                              subdomainResidual_);
+
+                // constraint degrees of freedom are not changed by the subdomain solve
+                Scalar error = 0.0;
+                for (unsigned locIdx = 0; locIdx < numDof; ++locIdx) {
+                    unsigned globalIdx = dofs[locIdx];
+                    if (checkConstraints && constraintsMap.count(globalIdx) > 0) {
+                        auto& row = matrix[locIdx];
+                        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                            *colIt = 0.0;
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            row[locIdx][eqIdx][eqIdx] = 1.0;
+                        subdomainResidual_[locIdx] = 0.0;
+                        continue;
+                    }
+
+                    const auto& weights = this->errorWeights_[globalIdx];
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        error = std::max<Scalar>(error, std::abs(subdomainResidual_[locIdx][eqIdx]*weights[eqIdx]));
+                }
+
+                if (!std::isfinite(error))
+                    throw NumericalIssue("The residual of a subdomain contains non-finite values");
+
+                if (iterIdx == 0)
+                    initialError = error;
+                else if (error > initialError) {
+                    succeeded = false;
+                    break;
+                }
+
+                if (error <= this->tolerance() || iterIdx >= maxIterations)
+                    break;
+
+                if (!solveSubdomainSystem_(matrix))
+                    throw NumericalIssue("The linear solver did not converge for a subdomain");
+
+                for (unsigned locIdx = 0; locIdx < numDof; ++locIdx) {
+                    unsigned globalIdx = dofs[locIdx];
+                    if (checkConstraints && constraintsMap.count(globalIdx) > 0)
+                        continue;
+
+                    PrimaryVariables currentValue(solution[globalIdx]);
+                    asImp_().updatePrimaryVariables_(globalIdx,
+                                                     solution[globalIdx],
+                                                     currentValue,
+                                                     subdomainUpdate_[locIdx],
+                                                     subdomainResidual_[locIdx]);
+                }
+                invalidateIntensiveQuantities_(dofs);
+            }
+        }
+        catch (const Dune::Exception&) {
+            succeeded = false;
+        }
+        catch (const NumericalIssue&) {
+            succeeded = false;
+        }
+
+        // the global iteration will deal with subdomains which could not be solved
+        // locally
+        if (!succeeded) {
+            for (unsigned locIdx = 0; locIdx < numDof; ++locIdx)
+                solution[dofs[locIdx]] = savedSolution_[locIdx];
+            invalidateIntensiveQuantities_(dofs);
+        }
+
+        return iterIdx;
+    }
+
+    // solve the linear system of equations of a subdomain. the result is stored in
+    // subdomainUpdate_.
+    bool solveSubdomainSystem_(const SubdomainMatrix& matrix)
+    {
+        using Operator = Dune::MatrixAdapter<SubdomainMatrix, GlobalEqVector, GlobalEqVector>;
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+        using Preconditioner = Dune::SeqILU<SubdomainMatrix, GlobalEqVector, GlobalEqVector>;
+#else
+        using Preconditioner = Dune::SeqILU0<SubdomainMatrix, GlobalEqVector, GlobalEqVector>;
+#endif
+        static constexpr int maxLinearIterations = 250;
+
+        Operator op(matrix);
+        Preconditioner preconditioner(matrix, /*relaxation=*/1.0);
+        Dune::BiCGSTABSolver<GlobalEqVector> solver(op,
+                                                    preconditioner,
+                                                    this->tightLinearTolerance_,
+                                                    maxLinearIterations,
+                                                    /*verbosity=*/0);
+
+        // the solver overwrites the right hand side
+        GlobalEqVector rhs(subdomainResidual_);
+        subdomainUpdate_ = 0.0;
+        Dune::InverseOperatorResult result;
+        solver.apply(subdomainUpdate_, rhs, result);
+
+        return result.converged;
+    }
+
+    void invalidateIntensiveQuantities_(const std::vector<unsigned>& dofs)
+    {
+        if (!model_().storeIntensiveQuantities())
+            return;
+
+        for (unsigned globalIdx : dofs)
+            model_().setIntensiveQuantitiesCacheEntryValidity(globalIdx,
+                                                              /*timeIdx=*/0,
+                                                              /*valid=*/false);
+    }
+
+    // divide the interior elements of the process into contiguous chunks of their
+    // reverse Cuthill-McKee ordering and set up the matrices of the subdomains
+    void updateSubdomains_()
+    {
+        const auto& gridView = this->simulator_.gridView();
+        const auto& dofMapper = model_().dofMapper();
+        size_t numGridDof = model_().numGridDof();
+
+        // the adjacency graph of the interior elements
+        std::vector<int> interiorIdx(numGridDof, -1);
+        std::vector<unsigned> interiorDofs;
+        std::vector<ElementSeed> interiorSeeds;
+        auto elemIt = gridView.template begin</*codim=*/0>();
+        const auto& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            if (elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            unsigned dofIdx = dofMapper.index(elem);
+            interiorIdx[dofIdx] = static_cast<int>(interiorDofs.size());
+            interiorDofs.push_back(dofIdx);
+            interiorSeeds.push_back(elem.seed());
+        }
+
+        std::vector<std::vector<unsigned>> adjacency(interiorDofs.size());
+        for (elemIt = gridView.template begin</*codim=*/0>(); elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            int myIdx = interiorIdx[dofMapper.index(elem)];
+            if (myIdx < 0)
+                continue;
+
+            auto isIt = gridView.ibegin(elem);
+            const auto& isEndIt = gridView.iend(elem);
+            for (; isIt != isEndIt; ++isIt) {
+                if (!isIt->neighbor())
+                    continue;
+
+                int neighborIdx = interiorIdx[dofMapper.index(isIt->outside())];
+                if (neighborIdx >= 0)
+                    adjacency[myIdx].push_back(static_cast<unsigned>(neighborIdx));
+            }
+        }
+
+        const auto& ordering = reverseCuthillMcKee(adjacency);
+        size_t numInterior = ordering.size();
+        size_t numSubdomains =
+            std::min<size_t>(std::max(EWOMS_GET_PARAM(TypeTag, int, NewtonNumSubdomains), 1),
+                             numInterior);
+
+        dofSubdomain_.assign(numGridDof, -1);
+        dofLocalIdx_.assign(numGridDof, 0);
+        subdomainDofs_.assign(numSubdomains, std::vector<unsigned>());
+        subdomainElements_.assign(numSubdomains, std::vector<ElementSeed>());
+        for (size_t pos = 0; pos < numInterior; ++pos) {
+            size_t subdomainIdx = pos*numSubdomains/numInterior;
+            unsigned idx = ordering[pos];
+            unsigned dofIdx = interiorDofs[idx];
+
+            dofSubdomain_[dofIdx] = static_cast<int>(subdomainIdx);
+            dofLocalIdx_[dofIdx] = static_cast<unsigned>(subdomainDofs_[subdomainIdx].size());
+            subdomainDofs_[subdomainIdx].push_back(dofIdx);
+            subdomainElements_[subdomainIdx].push_back(interiorSeeds[idx]);
+        }
+
+        // the couplings across the boundary of a subdomain are not considered
+        subdomainMatrices_.resize(numSubdomains);
+        for (size_t subdomainIdx = 0; subdomainIdx < numSubdomains; ++subdomainIdx) {
+            const auto& dofs = subdomainDofs_[subdomainIdx];
+            Dune::MatrixIndexSet indexSet(dofs.size(), dofs.size());
+            for (unsigned locIdx = 0; locIdx < dofs.size(); ++locIdx) {
+                indexSet.add(locIdx, locIdx);
+                for (unsigned neighborIdx : adjacency[interiorIdx[dofs[locIdx]]]) {
+                    unsigned neighborDofIdx = interiorDofs[neighborIdx];
+                    if (dofSubdomain_[neighborDofIdx] == static_cast<int>(subdomainIdx))
+                        indexSet.add(locIdx, dofLocalIdx_[neighborDofIdx]);
+                }
+            }
+            indexSet.exportIdx(subdomainMatrices_[subdomainIdx]);
+        }
+    }
+
     /*!
      * \brief Returns a reference to the model.
      */
@@ -165,6 +569,25 @@ private:
 
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    // the subdomain of each grid DOF (-1 if it is not part of any) and its index
+    // within the subdomain
+    std::vector<int> dofSubdomain_;
+    std::vector<unsigned> dofLocalIdx_;
+
+    // the DOFs, the elements and the Jacobian matrix of each subdomain
+    std::vector<std::vector<unsigned>> subdomainDofs_;
+    std::vector<std::vector<ElementSeed>> subdomainElements_;
+    std::vector<SubdomainMatrix> subdomainMatrices_;
+
+    // the error of each subdomain in the last global residual
+    std::vector<Scalar> subdomainError_;
+
+    // the residual, the update and the initial solution of the subdomain which is
+    // currently solved
+    GlobalEqVector subdomainResidual_;
+    GlobalEqVector subdomainUpdate_;
+    std::vector<PrimaryVariables> savedSolution_;
 };
 } // namespace Opm
 
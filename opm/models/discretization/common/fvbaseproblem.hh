@@ -76,6 +76,7 @@ private:
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
     using NewtonMethod = GetPropType<TypeTag, Properties::NewtonMethod>;
+    using TimeStepController = GetPropType<TypeTag, Properties::TimeStepController>;
 
     using VertexMapper = GetPropType<TypeTag, Properties::VertexMapper>;
     using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
@@ -121,6 +122,7 @@ public:
         , boundingBoxMin_(std::numeric_limits<double>::max())
         , boundingBoxMax_(-std::numeric_limits<double>::max())
         , simulator_(simulator)
+        , timeStepController_(simulator)
         , defaultVtkWriter_(0)
     {
         // calculate the bounding box of the local partition of the grid view
@@ -155,7 +157,9 @@ public:
             std::string outputDir = asImp_().outputDir();
 
             defaultVtkWriter_ =
-                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name(),
+                                   /*multiFileName=*/"",
+                                   EWOMS_GET_PARAM(TypeTag, unsigned, VtkOutputQueueSize));
         }
     }
 
@@ -169,6 +173,7 @@ public:
     static void registerParameters()
     {
         Model::registerParameters();
+        TimeStepController::registerParameters();
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MaxTimeStepSize,
                              "The maximum size to which all time steps are limited to [s]");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MinTimeStepSize,
@@ -178,6 +183,9 @@ public:
                              "before the simulation bails out");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncVtkOutput,
                              "Dispatch a separate thread to write the VTK output");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, VtkOutputQueueSize,
+                             "The maximum number of time steps which are queued for "
+                             "asynchronous VTK output");
         EWOMS_REGISTER_PARAM(TypeTag, bool, ContinueOnConvergenceError,
                              "Continue with a non-converged solution instead of giving up "
                              "if we encounter a time step size smaller than the minimum time "
@@ -518,12 +526,15 @@ public:
 
         std::string errorMessage;
         for (unsigned i = 0; i < maxFails; ++i) {
+            model().predictSolution();
             bool converged = model().update();
-            if (converged)
+            if (converged) {
+                timeStepController_.timeStepSucceeded();
                 return;
+            }
 
             Scalar dt = simulator().timeStepSize();
-            Scalar nextDt = dt / 2.0;
+            Scalar nextDt = timeStepController_.retryTimeStepSize(dt);
             if (dt < minTimeStepSize*(1 + 1e-9)) {
                 if (asImp_().continueOnConvergenceError()) {
                     if (gridView().comm().rank() == 0)
@@ -596,7 +607,7 @@ public:
             return nextTimeStepSize_;
 
         Scalar dtNext = std::min(EWOMS_GET_PARAM(TypeTag, Scalar, MaxTimeStepSize),
-                                 newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+                                 timeStepController_.suggestTimeStepSize(simulator().timeStepSize()));
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -717,6 +728,18 @@ public:
      */
     const NewtonMethod& newtonMethod() const
     { return model().newtonMethod(); }
+
+    /*!
+     * \brief Returns the object which determines the size of the time steps.
+     */
+    TimeStepController& timeStepController()
+    { return timeStepController_; }
+
+    /*!
+     * \brief Returns the object which determines the size of the time steps.
+     */
+    const TimeStepController& timeStepController() const
+    { return timeStepController_; }
     // \}
 
     /*!
@@ -833,6 +856,7 @@ private:
 
     // Attributes required for the actual simulation
     Simulator& simulator_;
+    TimeStepController timeStepController_;
     mutable VtkMultiWriter *defaultVtkWriter_;
 };
 
@@ -188,6 +188,9 @@ template<class TypeTag, class MyTypeTag>
 struct ThreadManager { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ThreadsPerProcess { using type = UndefinedProperty; };
+//! The number of NUMA domains across which the threads of a process are spread
+template<class TypeTag, class MyTypeTag>
+struct NumaDomains { using type = UndefinedProperty; };
 
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
@@ -196,6 +199,33 @@ struct ThreadsPerProcess { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct UseLinearizationLock { using type = UndefinedProperty; };
 
+//! Specify whether the Jacobian of the global system of equations should be calculated
+//! by perturbing structurally independent sets of degrees of freedom at once instead of
+//! linearizing each element separately. (only supported for finite differences.)
+template<class TypeTag, class MyTypeTag>
+struct UseColoredFiniteDifferences { using type = UndefinedProperty; };
+
+//! Specify whether the elements should be linearized in reverse Cuthill-McKee order
+//! instead of the order of the grid's element iterator
+template<class TypeTag, class MyTypeTag>
+struct EnableElementReordering { using type = UndefinedProperty; };
+
+//! Specify whether only the elements in the vicinity of degrees of freedom which
+//! changed since the last linearization ought to be linearized again. (only supported
+//! by the element centered finite volume discretization.)
+template<class TypeTag, class MyTypeTag>
+struct EnableLocalizedLinearization { using type = UndefinedProperty; };
+
+//! The weighted change of a primary variable above which the elements adjacent to a
+//! degree of freedom get linearized again by the localized linearization
+template<class TypeTag, class MyTypeTag>
+struct LocalizedLinearizationTolerance { using type = UndefinedProperty; };
+
+//! The number of Newton iterations after which the localized linearization linearizes
+//! all elements again
+template<class TypeTag, class MyTypeTag>
+struct LocalizedLinearizationFullInterval { using type = UndefinedProperty; };
+
 // high-level simulation control
 
 /*!
@@ -234,6 +264,15 @@ struct EnableVtkOutput { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableAsyncVtkOutput { using type = UndefinedProperty; };
 
+/*!
+ * \brief The maximum number of time steps which are queued for asynchronous VTK output
+ *
+ * If the queue is full, the simulation waits until the oldest time step has been
+ * written before the output of the next one is prepared.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputQueueSize { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify the format the VTK output is written to disk
  *
@@ -242,6 +281,9 @@ struct EnableAsyncVtkOutput { using type = UndefinedProperty; };
  *   - Dune::VTK::base64
  *   - Dune::VTK::appendedraw
  *   - Dune::VTK::appendedbase64
+ *   - Opm::VtuFormat::appendedRaw (native writer, raw binary appended data)
+ *   - Opm::VtuFormat::appendedCompressed (native writer, zlib compressed appended data)
+ *   - Opm::VtuFormat::xdmf (a single binary file for all time steps plus an XDMF description)
  */
 template<class TypeTag, class MyTypeTag>
 struct VtkOutputFormat { using type = UndefinedProperty; };
@@ -281,6 +323,30 @@ struct MaxTimeStepDivisions { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ContinueOnConvergenceError { using type = UndefinedProperty; };
 
+//! The class which determines the size of the time steps
+template<class TypeTag, class MyTypeTag>
+struct TimeStepController { using type = UndefinedProperty; };
+
+//! The weighted change of the primary variables over a time step which is targeted by
+//! the PID time step controller
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlTolerance { using type = UndefinedProperty; };
+
+//! The maximum factor by which the time step size may grow between two time steps
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlMaxGrowth { using type = UndefinedProperty; };
+
+//! The factor applied to the size of a failed time step before it is retried
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlRetryFactor { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the initial guess of the Newton method should be extrapolated
+ *        from the solutions of the last two time steps.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableSolutionPredictor { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether all intensive quantities for the grid should be
  *        cached in the discretization.
@@ -0,0 +1,224 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Classes which determine the size of the time steps of a simulation.
+ */
+#ifndef EWOMS_TIME_STEP_CONTROLLERS_HH
+#define EWOMS_TIME_STEP_CONTROLLERS_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/models/utils/parametersystem.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Determines the size of the time steps using the number of iterations which
+ *        were required by the Newton method.
+ *
+ * Failed time steps are retried using half of the size of the failed attempt. This is
+ * the default behavior of the finite volume discretizations.
+ */
+template <class TypeTag>
+class IterationCountTimeStepController
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+
+public:
+    IterationCountTimeStepController(const Simulator& simulator)
+        : simulator_(simulator)
+    {}
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    { }
+
+    /*!
+     * \brief Called by the problem after a time step has been successfully computed.
+     *
+     * At this point, the solution of the time step and the one of the previous time
+     * step are both still available.
+     */
+    void timeStepSucceeded()
+    { }
+
+    /*!
+     * \brief Returns the size of the time step which ought to be used to retry a time
+     *        step which did not converge.
+     *
+     * \param failedDt The size of the time step which did not converge [s]
+     */
+    Scalar retryTimeStepSize(Scalar failedDt) const
+    { return failedDt/2.0; }
+
+    /*!
+     * \brief Returns the size of the next time step after a successful one.
+     *
+     * \param oldDt The size of the time step which was just completed [s]
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    { return simulator_.model().newtonMethod().suggestTimeStepSize(oldDt); }
+
+protected:
+    const Simulator& simulator_;
+};
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Determines the size of the time steps using a PID controller on the change
+ *        of the solution over a time step.
+ *
+ * The change of a time step is the maximum of the weighted difference of the primary
+ * variables between the current and the previous time level. The controller aims at
+ * keeping this change at the value of the TimeStepControlTolerance parameter by
+ * considering the changes of the last three time steps. The growth of the time step
+ * size is limited by the TimeStepControlMaxGrowth parameter and the step size
+ * suggested by the iteration count of the Newton method is never exceeded.
+ *
+ * For details, see
+ *
+ * G. Söderlind: "Automatic Control and Adaptive Time-Stepping", Numerical
+ * Algorithms 31, pp. 281-310, 2002
+ */
+template <class TypeTag>
+class PidTimeStepController : public IterationCountTimeStepController<TypeTag>
+{
+    using ParentType = IterationCountTimeStepController<TypeTag>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    // the gains of the proportional, the integral and the derivative terms
+    static constexpr Scalar kP = 0.075;
+    static constexpr Scalar kI = 0.175;
+    static constexpr Scalar kD = 0.01;
+
+public:
+    PidTimeStepController(const Simulator& simulator)
+        : ParentType(simulator)
+        , tolerance_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTolerance))
+        , maxGrowth_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth))
+        , retryFactor_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlRetryFactor))
+        , numErrors_(0)
+    {
+        std::fill(errors_, errors_ + 3, 1.0);
+    }
+
+    /*!
+     * \copydoc IterationCountTimeStepController::registerParameters
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTolerance,
+                             "The weighted change of the primary variables over a time step "
+                             "which is targeted by the PID time step controller");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth,
+                             "The maximum factor by which the time step size may grow from "
+                             "one time step to the next");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlRetryFactor,
+                             "The factor applied to the size of a time step which did not "
+                             "converge before it is retried");
+    }
+
+    /*!
+     * \copydoc IterationCountTimeStepController::timeStepSucceeded
+     */
+    void timeStepSucceeded()
+    {
+        const auto& model = this->simulator_.model();
+        const auto& solution = model.solution(/*timeIdx=*/0);
+        const auto& oldSolution = model.solution(/*timeIdx=*/1);
+
+        Scalar change = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < model.numGridDof(); ++dofIdx) {
+            if (!model.isLocalDof(dofIdx))
+                continue;
+
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                Scalar delta = std::abs(solution[dofIdx][pvIdx] - oldSolution[dofIdx][pvIdx]);
+                change = std::max(change, delta*model.primaryVarWeight(dofIdx, pvIdx));
+            }
+        }
+        change = this->simulator_.gridView().comm().max(change);
+
+        // shift the history of the relative errors
+        errors_[0] = errors_[1];
+        errors_[1] = errors_[2];
+        errors_[2] = std::max<Scalar>(change/tolerance_, 1e-10);
+        numErrors_ = std::min(numErrors_ + 1, 3u);
+    }
+
+    /*!
+     * \copydoc IterationCountTimeStepController::retryTimeStepSize
+     */
+    Scalar retryTimeStepSize(Scalar failedDt) const
+    { return failedDt*retryFactor_; }
+
+    /*!
+     * \copydoc IterationCountTimeStepController::suggestTimeStepSize
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    {
+        Scalar factor;
+        if (errors_[2] > 1.0)
+            // the change was too large: reduce the step size proportionally
+            factor = 1.0/errors_[2];
+        else if (numErrors_ < 3)
+            // not enough history for the proportional and derivative terms yet
+            factor = std::pow(1.0/errors_[2], kI);
+        else
+            factor =
+                std::pow(errors_[1]/errors_[2], kP)
+                * std::pow(1.0/errors_[2], kI)
+                * std::pow(errors_[0]*errors_[0]/(errors_[1]*errors_[2]), kD);
+
+        Scalar dt = oldDt*std::min(factor, maxGrowth_);
+        return std::min(dt, ParentType::suggestTimeStepSize(oldDt));
+    }
+
+private:
+    Scalar tolerance_;
+    Scalar maxGrowth_;
+    Scalar retryFactor_;
+
+    // the changes of the last three time steps relative to the tolerance. the most
+    // recent one is the last.
+    Scalar errors_[3];
+    unsigned numErrors_;
+};
+
+} // namespace Opm
+
+#endif
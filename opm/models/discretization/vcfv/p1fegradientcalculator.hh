@@ -110,6 +110,8 @@ public:
             const LocalFiniteElement& localFE = feCache_.get(elemCtx.element().type());
             localFiniteElement_ = &localFE;
 
+            std::vector<ShapeJacobian> localGradient;
+
             // loop over all face centeres
             for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
                 const auto& localFacePos = stencil.interiorFace(faceIdx).localPos();
@@ -121,7 +123,6 @@ public:
 
                 if (prepareGradients) {
                     // first, get the shape function's gradient in local coordinates
-                    std::vector<ShapeJacobian> localGradient;
                     localFE.localBasis().evaluateJacobian(localFacePos, localGradient);
 
                     // convert to a gradient in global space by
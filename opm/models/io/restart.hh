@@ -27,18 +27,62 @@
 #ifndef EWOMS_RESTART_HH
 #define EWOMS_RESTART_HH
 
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 
 namespace Opm {
 
 /*!
  * \brief Load or save a state of a problem to/from the harddisk.
+ *
+ * Two file formats are supported: The text format writes each section and each
+ * entity as human readable lines. The binary format collects the data of each
+ * section in memory and writes it as a contiguous block. The entity data is written
+ * using the raw representation of the serializer (see
+ * FvBaseDiscretization::serializeEntityBinary()). The file starts with a header,
+ * and the offset, size and checksum of every section are stored in a table at the
+ * end of the file. When a restart file is read, its format is detected
+ * automatically. Binary files are read into memory as a whole and the checksum of
+ * each section is verified before the section is deserialized.
  */
 class Restart
 {
+    // the first bytes of a binary restart file
+    static constexpr const char* binaryMagic_ = "EWOMSRB1";
+    // the last bytes of a binary restart file
+    static constexpr const char* binaryEndMagic_ = "EWOMSEND";
+    static constexpr size_t magicLength_ = 8;
+    // used to detect files which were written on a machine with different endianess
+    static constexpr std::uint32_t byteOrderMark_ = 0x01020304;
+
+    struct SectionInfo_
+    {
+        std::string name;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t checksum;
+    };
+
+    // the 64 bit Fowler-Noll-Vo (FNV-1a) hash of a memory region
+    static std::uint64_t checksum_(const char* data, size_t size)
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
     /*!
      * \brief Create a magic cookie for restart files, so that it is
      *        unlikely to load a restart file for an incorrectly.
@@ -88,6 +132,25 @@ class Restart
     }
 
 public:
+    /*!
+     * \brief Create a restart object.
+     *
+     * \param binary If true, the binary format is used to write restart files. The
+     *               format of files which are read is always detected automatically.
+     * \param staged If true, the serialized data is kept in memory and only written
+     *               to disk by writeStaged().
+     */
+    explicit Restart(bool binary = false, bool staged = false)
+        : binary_(binary)
+        , staged_(staged)
+    {}
+
+    /*!
+     * \brief Returns true if the binary file format is used.
+     */
+    bool binary() const
+    { return binary_; }
+
     /*!
      * \brief Returns the name of the file which is (de-)serialized.
      */
@@ -106,9 +169,26 @@ public:
                                      simulator.problem().name(),
                                      simulator.time());
 
-        // open output file and write magic cookie
-        outStream_.open(fileName_.c_str());
-        outStream_.precision(20);
+        // open output file and write magic cookie. if the output is staged, the
+        // data is kept in memory until writeStaged() is called
+        if (staged_) {
+            stagingStream_.str("");
+            stagingStream_.clear();
+            outStream_ = &stagingStream_;
+        }
+        else {
+            outFile_.open(tempFileName_().c_str(), binary_ ? std::ios::out | std::ios::binary : std::ios::out);
+            outStream_ = &outFile_;
+        }
+
+        if (binary_) {
+            outStream_->write(binaryMagic_, magicLength_);
+            writeRaw_(*outStream_, byteOrderMark_);
+            sections_.clear();
+            sectionBuffer_.precision(20);
+        }
+        else
+            outStream_->precision(20);
 
         serializeSectionBegin(magicCookie);
         serializeSectionEnd();
@@ -118,19 +198,43 @@ public:
      * \brief The output stream to write the serialized data.
      */
     std::ostream& serializeStream()
-    { return outStream_; }
+    { return binary_ ? static_cast<std::ostream&>(sectionBuffer_) : *outStream_; }
 
     /*!
      * \brief Start a new section in the serialized output.
      */
     void serializeSectionBegin(const std::string& cookie)
-    { outStream_ << cookie << "\n"; }
+    {
+        if (binary_) {
+            sectionName_ = cookie;
+            sectionBuffer_.str("");
+            sectionBuffer_.clear();
+        }
+        else
+            *outStream_ << cookie << "\n";
+    }
 
     /*!
      * \brief End of a section in the serialized output.
      */
     void serializeSectionEnd()
-    { outStream_ << "\n"; }
+    {
+        if (binary_) {
+            // write the data of the section as one contiguous block
+            const std::string& data = sectionBuffer_.str();
+            SectionInfo_ info;
+            info.name = sectionName_;
+            info.offset = static_cast<std::uint64_t>(outStream_->tellp());
+            info.size = data.size();
+            info.checksum = checksum_(data.data(), data.size());
+            outStream_->write(data.data(), static_cast<std::streamsize>(data.size()));
+            sections_.push_back(info);
+
+            sectionBuffer_.str("");
+        }
+        else
+            *outStream_ << "\n";
+    }
 
     /*!
      * \brief Serialize all leaf entities of a codim in a gridView.
@@ -150,9 +254,15 @@ public:
 
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
-        for (; it != endIt; ++it) {
-            serializer.serializeEntity(outStream_, *it);
-            outStream_ << "\n";
+        if (binary_) {
+            for (; it != endIt; ++it)
+                serializer.serializeEntityBinary(sectionBuffer_, *it);
+        }
+        else {
+            for (; it != endIt; ++it) {
+                serializer.serializeEntity(*outStream_, *it);
+                *outStream_ << "\n";
+            }
         }
 
         serializeSectionEnd();
@@ -162,7 +272,52 @@ public:
      * \brief Finish the restart file.
      */
     void serializeEnd()
-    { outStream_.close(); }
+    {
+        if (binary_) {
+            // write the table of sections and the footer which points to it
+            std::uint64_t tableOffset = static_cast<std::uint64_t>(outStream_->tellp());
+            writeRaw_(*outStream_, static_cast<std::uint64_t>(sections_.size()));
+            for (const auto& info : sections_) {
+                writeRaw_(*outStream_, static_cast<std::uint64_t>(info.name.size()));
+                outStream_->write(info.name.data(), static_cast<std::streamsize>(info.name.size()));
+                writeRaw_(*outStream_, info.offset);
+                writeRaw_(*outStream_, info.size);
+                writeRaw_(*outStream_, info.checksum);
+            }
+            writeRaw_(*outStream_, tableOffset);
+            outStream_->write(binaryEndMagic_, magicLength_);
+
+        }
+
+        if (!outStream_->good())
+            throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+
+        if (!staged_) {
+            outFile_.close();
+            commitTempFile_();
+        }
+    }
+
+    /*!
+     * \brief Write the data which has been staged in memory to the restart file.
+     *
+     * This method must be called after serializeEnd() if the restart object was
+     * created with the staged flag. Since it does not access the simulator, it
+     * may be called from a different thread than the one which serialized the data.
+     */
+    void writeStaged()
+    {
+        const std::string& data = stagingStream_.str();
+        std::ofstream outFile(tempFileName_().c_str(), binary_ ? std::ios::out | std::ios::binary : std::ios::out);
+        outFile.write(data.data(), static_cast<std::streamsize>(data.size()));
+        outFile.close();
+        if (!outFile.good())
+            throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+        commitTempFile_();
+
+        // release the memory of the staging buffer
+        stagingStream_.str("");
+    }
 
     /*!
      * \brief Start reading a restart file at a certain simulated
@@ -187,6 +342,16 @@ public:
         }
         inStream_.seekg(0, std::ios::beg);
 
+        // check whether the file uses the binary format
+        char magic[magicLength_] = {};
+        inStream_.read(magic, magicLength_);
+        binary_ = inStream_.good() && std::memcmp(magic, binaryMagic_, magicLength_) == 0;
+        inStream_.clear();
+        inStream_.seekg(0, std::ios::beg);
+
+        if (binary_)
+            readBinaryFile_(static_cast<size_t>(pos));
+
         const std::string magicCookie = magicRestartCookie_(simulator.gridView());
 
         deserializeSectionBegin(magicCookie);
@@ -198,13 +363,31 @@ public:
      *        deserialized.
      */
     std::istream& deserializeStream()
-    { return inStream_; }
+    { return binary_ ? static_cast<std::istream&>(sectionInStream_) : inStream_; }
 
     /*!
      * \brief Start reading a new section of the restart file.
      */
     void deserializeSectionBegin(const std::string& cookie)
     {
+        if (binary_) {
+            if (curSectionIdx_ >= sections_.size())
+                throw std::runtime_error("Encountered unexpected EOF in restart file.");
+
+            const SectionInfo_& info = sections_[curSectionIdx_];
+            if (info.name != cookie)
+                throw std::runtime_error("Could not start section '"+cookie+"'");
+
+            const char* data = fileData_.data() + info.offset;
+            if (checksum_(data, info.size) != info.checksum)
+                throw std::runtime_error("Checksum mismatch in section '"+cookie+"' of restart file '"
+                                         +fileName_+"'");
+
+            sectionInStream_.clear();
+            sectionInStream_.str(std::string(data, info.size));
+            return;
+        }
+
         if (!inStream_.good())
             throw std::runtime_error("Encountered unexpected EOF in restart file.");
         std::string buf;
@@ -218,6 +401,17 @@ public:
      */
     void deserializeSectionEnd()
     {
+        if (binary_) {
+            std::string rest((std::istreambuf_iterator<char>(sectionInStream_)),
+                             std::istreambuf_iterator<char>());
+            for (char c : rest) {
+                if (!std::isspace(static_cast<unsigned char>(c)))
+                    throw std::logic_error("Encountered unread values while deserializing");
+            }
+            ++curSectionIdx_;
+            return;
+        }
+
         std::string dummy;
         std::getline(inStream_, dummy);
         for (unsigned i = 0; i < dummy.length(); ++i) {
@@ -246,6 +440,18 @@ public:
         using Iterator = typename GridView::template Codim<codim>::Iterator;
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
+        if (binary_) {
+            for (; it != endIt; ++it) {
+                if (!sectionInStream_.good())
+                    throw std::runtime_error("Restart file is corrupted");
+
+                deserializer.deserializeEntityBinary(sectionInStream_, *it);
+            }
+
+            deserializeSectionEnd();
+            return;
+        }
+
         for (; it != endIt; ++it) {
             if (!inStream_.good()) {
                 throw std::runtime_error("Restart file is corrupted");
@@ -263,12 +469,97 @@ public:
      * \brief Stop reading the restart file.
      */
     void deserializeEnd()
-    { inStream_.close(); }
+    {
+        inStream_.close();
+        fileData_.clear();
+        fileData_.shrink_to_fit();
+        sections_.clear();
+        sectionInStream_.str("");
+    }
 
 private:
+    // the restart file is written to a temporary file which is only renamed once it is
+    // complete, so that a crash while writing cannot leave a truncated restart file
+    std::string tempFileName_() const
+    { return fileName_ + ".tmp"; }
+
+    void commitTempFile_() const
+    {
+        if (std::rename(tempFileName_().c_str(), fileName_.c_str()) != 0)
+            throw std::runtime_error("Could not rename the temporary restart file '"
+                                     +tempFileName_()+"' to '"+fileName_+"'");
+    }
+
+    template <class T>
+    static void writeRaw_(std::ostream& os, const T& value)
+    { os.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    template <class T>
+    T readRaw_(size_t& pos) const
+    {
+        if (pos + sizeof(T) > fileData_.size())
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+
+        T value;
+        std::memcpy(&value, fileData_.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    // read a binary restart file into memory using a single read operation and parse
+    // its table of sections
+    void readBinaryFile_(size_t fileSize)
+    {
+        fileData_.resize(fileSize);
+        inStream_.close();
+        inStream_.open(fileName_.c_str(), std::ios::in | std::ios::binary);
+        inStream_.read(fileData_.data(), static_cast<std::streamsize>(fileSize));
+        if (static_cast<size_t>(inStream_.gcount()) != fileSize)
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be read");
+
+        size_t pos = magicLength_;
+        if (readRaw_<std::uint32_t>(pos) != byteOrderMark_)
+            throw std::runtime_error("Restart file '"+fileName_+"' was written on a machine "
+                                     "with a different byte order");
+
+        if (fileSize < 2*magicLength_ + sizeof(std::uint64_t)
+            || std::memcmp(fileData_.data() + fileSize - magicLength_, binaryEndMagic_, magicLength_) != 0)
+            throw std::runtime_error("Restart file '"+fileName_+"' is truncated");
+
+        pos = fileSize - magicLength_ - sizeof(std::uint64_t);
+        pos = static_cast<size_t>(readRaw_<std::uint64_t>(pos));
+        size_t numSections = static_cast<size_t>(readRaw_<std::uint64_t>(pos));
+        sections_.resize(numSections);
+        for (auto& info : sections_) {
+            size_t nameLength = static_cast<size_t>(readRaw_<std::uint64_t>(pos));
+            if (pos + nameLength > fileData_.size())
+                throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+            info.name.assign(fileData_.data() + pos, nameLength);
+            pos += nameLength;
+            info.offset = readRaw_<std::uint64_t>(pos);
+            info.size = readRaw_<std::uint64_t>(pos);
+            info.checksum = readRaw_<std::uint64_t>(pos);
+            if (info.offset + info.size > fileData_.size())
+                throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+        }
+        curSectionIdx_ = 0;
+    }
+
+    bool binary_;
+    bool staged_;
     std::string fileName_;
     std::ifstream inStream_;
-    std::ofstream outStream_;
+    std::ofstream outFile_;
+    std::ostringstream stagingStream_;
+    std::ostream* outStream_ = nullptr;
+
+    // state of the binary format
+    std::vector<SectionInfo_> sections_;
+    std::string sectionName_;
+    std::ostringstream sectionBuffer_;
+    std::vector<char> fileData_;
+    std::istringstream sectionInStream_;
+    size_t curSectionIdx_ = 0;
 };
 } // namespace Opm
 
@@ -31,6 +31,8 @@
 #include "vtkscalarfunction.hh"
 #include "vtkvectorfunction.hh"
 #include "vtktensorfunction.hh"
+#include "vtuwriter.hh"
+#include "xdmfwriter.hh"
 
 #include <opm/models/io/baseoutputwriter.hh>
 #include <opm/models/parallel/tasklets.hh>
@@ -48,8 +50,14 @@
 #include <mpi.h>
 #endif
 
+#include <algorithm>
+#include <condition_variable>
+#include <iomanip>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include <limits>
 #include <sstream>
 #include <fstream>
@@ -65,25 +73,97 @@ namespace Opm {
 template <class GridView, int vtkFormat>
 class VtkMultiWriter : public BaseOutputWriter
 {
+    enum { dim = GridView::dimension };
+
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    static constexpr bool nativeVtu = isNativeVtuFormat(vtkFormat);
+    static constexpr bool xdmfOutput = (vtkFormat == VtuFormat::xdmf);
+    static constexpr bool nativeOutput = nativeVtu || xdmfOutput;
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using Vector = BaseOutputWriter::Vector;
+    using Tensor = BaseOutputWriter::Tensor;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    using NativeWriter = typename std::conditional<xdmfOutput,
+                                                   XdmfWriter<GridView, VertexMapper, ElementMapper>,
+                                                   VtuWriter<GridView, VertexMapper, ElementMapper> >::type;
+    using VtkWriter = typename std::conditional<nativeOutput,
+                                                NativeWriter,
+                                                Dune::VTKWriter<GridView> >::type;
+    using FunctionPtr = std::shared_ptr< Dune::VTKFunction< GridView > >;
+
+private:
+    // everything which is required to write the data of a single time step
+    struct PendingWrite_
+    {
+        std::unique_ptr<VtkWriter> writer;
+        double time;
+        std::string outFileName;
+
+        std::list<ScalarBuffer*> scalarBuffers;
+        std::list<VectorBuffer*> vectorBuffers;
+        std::list<TensorBuffer*> tensorBuffers;
+    };
+
     class WriteDataTasklet : public TaskletInterface
     {
     public:
-        WriteDataTasklet(VtkMultiWriter& multiWriter)
+        WriteDataTasklet(VtkMultiWriter& multiWriter, std::unique_ptr<PendingWrite_> write)
             : multiWriter_(multiWriter)
+            , write_(std::move(write))
         { }
 
         void run() final
+        {
+            // make sure that the write is always finished, else the simulation would
+            // wait forever for room in the queue of pending writes
+            try {
+                writeData_();
+            }
+            catch (...) {
+                multiWriter_.finishPendingWrite_(std::move(write_));
+                throw;
+            }
+
+            multiWriter_.finishPendingWrite_(std::move(write_));
+        }
+
+    private:
+        void writeData_()
+        {
+            if constexpr (xdmfOutput) {
+                // the description of the time step is only returned on the first rank
+                const std::string& stepXml = write_->writer->write(write_->time);
+                if (multiWriter_.commRank_ == 0)
+                    multiWriter_.multiFile_ << stepXml;
+            }
+            else
+                writeVtkData_();
+
+            // temporarily write the closing XML mumbo-jumbo to the mashup
+            // file so that the data set can be loaded even if the
+            // simulation is aborted (or not yet finished)
+            multiWriter_.finishMultiFile_();
+        }
+
+        void writeVtkData_()
         {
             std::string fileName;
             // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
             if (multiWriter_.commSize_ > 1)
-                fileName = multiWriter_.curWriter_->pwrite(/*name=*/multiWriter_.curOutFileName_,
-                                                           /*path=*/multiWriter_.outputDir_,
-                                                           /*extendPath=*/"",
-                                                           static_cast<Dune::VTK::OutputType>(vtkFormat));
+                fileName = write_->writer->pwrite(/*name=*/write_->outFileName,
+                                                  /*path=*/multiWriter_.outputDir_,
+                                                  /*extendPath=*/"",
+                                                  outputType_());
             else
-                fileName = multiWriter_.curWriter_->write(/*name=*/multiWriter_.outputDir_ + "/" + multiWriter_.curOutFileName_,
-                                                          static_cast<Dune::VTK::OutputType>(vtkFormat));
+                fileName = write_->writer->write(/*name=*/multiWriter_.outputDir_ + "/" + write_->outFileName,
+                                                 outputType_());
 
             // determine name to write into the multi-file for the
             // current time step
@@ -91,41 +171,46 @@ class VtkMultiWriter : public BaseOutputWriter
             const filesystem::path fullPath{fileName};
             const std::string localFileName = fullPath.filename();
             multiWriter_.multiFile_.precision(16);
-            multiWriter_.multiFile_ << "   <DataSet timestep=\"" << multiWriter_.curTime_ << "\" file=\""
+            multiWriter_.multiFile_ << "   <DataSet timestep=\"" << write_->time << "\" file=\""
                                     << localFileName << "\"/>\n";
         }
 
-    private:
         VtkMultiWriter& multiWriter_;
+        std::unique_ptr<PendingWrite_> write_;
     };
 
-    enum { dim = GridView::dimension };
-
-    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
-    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    // the output type passed to Dune::VTKWriter. the native writers always use
+    // binary data
+    static constexpr Dune::VTK::OutputType outputType_()
+    { return static_cast<Dune::VTK::OutputType>(nativeOutput ? Dune::VTK::appendedraw : vtkFormat); }
 
 public:
-    using Scalar = BaseOutputWriter::Scalar;
-    using Vector = BaseOutputWriter::Vector;
-    using Tensor = BaseOutputWriter::Tensor;
-    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
-    using VectorBuffer = BaseOutputWriter::VectorBuffer;
-    using TensorBuffer = BaseOutputWriter::TensorBuffer;
-
-    using VtkWriter = Dune::VTKWriter<GridView>;
-    using FunctionPtr = std::shared_ptr< Dune::VTKFunction< GridView > >;
-
+    /*!
+     * \brief Create a multi-file writer.
+     *
+     * If asyncWriting is true, the files are written by a separate thread. In this
+     * case, up to maxPendingWrites time steps may be queued for writing while the
+     * simulation continues. XDMF output is always written synchronously if more than
+     * one process is involved because it requires collective communication. The data
+     * attached to the writer is copied into buffers which are recycled between time
+     * steps, so the caller may modify its own buffers as soon as endWrite() has been
+     * called.
+     */
     VtkMultiWriter(bool asyncWriting,
                    const GridView& gridView,
                    const std::string& outputDir,
                    const std::string& simName = "",
-                   std::string multiFileName = "")
+                   std::string multiFileName = "",
+                   unsigned maxPendingWrites = 1)
         : gridView_(gridView)
         , elementMapper_(gridView, Dune::mcmgElementLayout())
         , vertexMapper_(gridView, Dune::mcmgVertexLayout())
-        , curWriter_(nullptr)
         , curWriterNum_(0)
-        , taskletRunner_(/*numThreads=*/asyncWriting?1:0)
+        , asyncWriting_(asyncWriting && !(xdmfOutput && gridView.comm().size() > 1))
+        , maxPendingWrites_(std::max(maxPendingWrites, 1u))
+        , numPendingWrites_(0)
+        , vtuMesh_(std::make_shared<VtuMesh>())
+        , taskletRunner_(/*numThreads=*/asyncWriting_?1:0)
     {
         outputDir_ = outputDir;
         if (outputDir == "")
@@ -134,20 +219,32 @@ public:
         simName_ = (simName.empty()) ? "sim" : simName;
         multiFileName_ = multiFileName;
         if (multiFileName_.empty())
-            multiFileName_ = outputDir_+"/"+simName_+".pvd";
+            multiFileName_ = outputDir_+"/"+simName_+(xdmfOutput ? ".xmf" : ".pvd");
 
         commRank_ = gridView.comm().rank();
         commSize_ = gridView.comm().size();
+
+        // with XDMF output, the data of all time steps is written to a single file
+        if (xdmfOutput)
+            xdmfContainer_.reset(new XdmfContainer<GridView>(gridView, outputDir_+"/"+simName_+".bin"));
     }
 
     ~VtkMultiWriter()
     {
         taskletRunner_.barrier();
-        releaseBuffers_();
+        if (curWrite_)
+            releaseBuffers_(*curWrite_);
         finishMultiFile_();
 
         if (commRank_ == 0)
             multiFile_.close();
+
+        for (auto* buf : scalarBufferPool_)
+            delete buf;
+        for (auto* buf : vectorBufferPool_)
+            delete buf;
+        for (auto* buf : tensorBufferPool_)
+            delete buf;
     }
 
     /*!
@@ -165,8 +262,16 @@ public:
      */
     void gridChanged()
     {
+        // the pending writes use the mappers
+        taskletRunner_.barrier();
+
         elementMapper_.update();
         vertexMapper_.update();
+
+        // the encoded grid of the native writers must be recomputed
+        vtuMesh_ = std::make_shared<VtuMesh>();
+        if (xdmfContainer_)
+            xdmfContainer_->gridChanged();
     }
 
     /*!
@@ -178,15 +283,24 @@ public:
             startMultiFile_(multiFileName_);
         }
 
-        // make sure that all previous output has been written and no other thread
-        // accesses the memory used as the target for the extracted quantities
-        taskletRunner_.barrier();
-        releaseBuffers_();
-
-        curTime_ = t;
-        curOutFileName_ = fileName_();
-
-        curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
+        // wait until there is room in the queue of pending writes. since the data of
+        // each pending write is stored in its own buffers, the previous output does
+        // not need to be written completely before the next one can be prepared.
+        waitForPendingWrites_(maxPendingWrites_ - 1);
+        if (curWrite_)
+            releaseBuffers_(*curWrite_);
+
+        curWrite_.reset(new PendingWrite_);
+        curWrite_->time = t;
+        curWrite_->outFileName = fileName_();
+        if constexpr (xdmfOutput)
+            curWrite_->writer.reset(new VtkWriter(gridView_, vertexMapper_, elementMapper_, *xdmfContainer_));
+        else if constexpr (nativeVtu)
+            curWrite_->writer.reset(new VtkWriter(gridView_, vertexMapper_, elementMapper_,
+                                                  /*compress=*/vtkFormat == VtuFormat::appendedCompressed,
+                                                  vtuMesh_));
+        else
+            curWrite_->writer.reset(new VtkWriter(gridView_, Dune::VTK::conforming));
         ++curWriterNum_;
     }
 
@@ -198,8 +312,9 @@ public:
      */
     ScalarBuffer *allocateManagedScalarBuffer(size_t numEntities)
     {
-        ScalarBuffer *buf = new ScalarBuffer(numEntities);
-        managedScalarBuffers_.push_back(buf);
+        ScalarBuffer *buf = acquireBuffer_(scalarBufferPool_);
+        buf->assign(numEntities, 0.0);
+        curWrite_->scalarBuffers.push_back(buf);
         return buf;
     }
 
@@ -211,11 +326,14 @@ public:
      */
     VectorBuffer *allocateManagedVectorBuffer(size_t numOuter, size_t numInner)
     {
-        VectorBuffer *buf = new VectorBuffer(numOuter);
-        for (size_t i = 0; i < numOuter; ++ i)
+        VectorBuffer *buf = acquireBuffer_(vectorBufferPool_);
+        buf->resize(numOuter);
+        for (size_t i = 0; i < numOuter; ++ i) {
             (*buf)[i].resize(numInner);
+            (*buf)[i] = 0.0;
+        }
 
-        managedVectorBuffers_.push_back(buf);
+        curWrite_->vectorBuffers.push_back(buf);
         return buf;
     }
 
@@ -235,17 +353,22 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behavior_.
      */
-    void attachScalarVertexData(ScalarBuffer& buf, std::string name)
+    void attachScalarVertexData(ScalarBuffer& userBuf, std::string name)
     {
+        ScalarBuffer& buf = stageBuffer_(userBuf, curWrite_->scalarBuffers, scalarBufferPool_);
         sanitizeScalarBuffer_(buf);
 
-        using VtkFn = VtkScalarFunction<GridView, VertexMapper>;
-        FunctionPtr fnPtr(new VtkFn(name,
-                                    gridView_,
-                                    vertexMapper_,
-                                    buf,
-                                    /*codim=*/dim));
-        curWriter_->addVertexData(fnPtr);
+        if constexpr (nativeOutput)
+            curWrite_->writer->addScalarVertexData(buf, name);
+        else {
+            using VtkFn = VtkScalarFunction<GridView, VertexMapper>;
+            FunctionPtr fnPtr(new VtkFn(name,
+                                        gridView_,
+                                        vertexMapper_,
+                                        buf,
+                                        /*codim=*/dim));
+            curWrite_->writer->addVertexData(fnPtr);
+        }
     }
 
     /*!
@@ -263,17 +386,22 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behaviour_.
      */
-    void attachScalarElementData(ScalarBuffer& buf, std::string name)
+    void attachScalarElementData(ScalarBuffer& userBuf, std::string name)
     {
+        ScalarBuffer& buf = stageBuffer_(userBuf, curWrite_->scalarBuffers, scalarBufferPool_);
         sanitizeScalarBuffer_(buf);
 
-        using VtkFn = VtkScalarFunction<GridView, ElementMapper>;
-        FunctionPtr fnPtr(new VtkFn(name,
-                                    gridView_,
-                                    elementMapper_,
-                                    buf,
-                                    /*codim=*/0));
-        curWriter_->addCellData(fnPtr);
+        if constexpr (nativeOutput)
+            curWrite_->writer->addScalarCellData(buf, name);
+        else {
+            using VtkFn = VtkScalarFunction<GridView, ElementMapper>;
+            FunctionPtr fnPtr(new VtkFn(name,
+                                        gridView_,
+                                        elementMapper_,
+                                        buf,
+                                        /*codim=*/0));
+            curWrite_->writer->addCellData(fnPtr);
+        }
     }
 
     /*!
@@ -292,37 +420,47 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behavior_.
      */
-    void attachVectorVertexData(VectorBuffer& buf, std::string name)
+    void attachVectorVertexData(VectorBuffer& userBuf, std::string name)
     {
+        VectorBuffer& buf = stageBuffer_(userBuf, curWrite_->vectorBuffers, vectorBufferPool_);
         sanitizeVectorBuffer_(buf);
 
-        using VtkFn = VtkVectorFunction<GridView, VertexMapper>;
-        FunctionPtr fnPtr(new VtkFn(name,
-                                    gridView_,
-                                    vertexMapper_,
-                                    buf,
-                                    /*codim=*/dim));
-        curWriter_->addVertexData(fnPtr);
+        if constexpr (nativeOutput)
+            curWrite_->writer->addVectorVertexData(buf, name);
+        else {
+            using VtkFn = VtkVectorFunction<GridView, VertexMapper>;
+            FunctionPtr fnPtr(new VtkFn(name,
+                                        gridView_,
+                                        vertexMapper_,
+                                        buf,
+                                        /*codim=*/dim));
+            curWrite_->writer->addVertexData(fnPtr);
+        }
     }
 
     /*!
      * \brief Add a finished vertex-centered tensor field to the output.
      */
-    void attachTensorVertexData(TensorBuffer& buf, std::string name)
+    void attachTensorVertexData(TensorBuffer& userBuf, std::string name)
     {
         using VtkFn = VtkTensorFunction<GridView, VertexMapper>;
+        TensorBuffer& buf = stageBuffer_(userBuf, curWrite_->tensorBuffers, tensorBufferPool_);
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
-            FunctionPtr fnPtr(new VtkFn(oss.str(),
-                                        gridView_,
-                                        vertexMapper_,
-                                        buf,
-                                        /*codim=*/dim,
-                                        colIdx));
-            curWriter_->addVertexData(fnPtr);
+            if constexpr (nativeOutput)
+                curWrite_->writer->addTensorVertexData(buf, colIdx, oss.str());
+            else {
+                FunctionPtr fnPtr(new VtkFn(oss.str(),
+                                            gridView_,
+                                            vertexMapper_,
+                                            buf,
+                                            /*codim=*/dim,
+                                            colIdx));
+                curWrite_->writer->addVertexData(fnPtr);
+            }
         }
     }
 
@@ -341,37 +479,47 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behaviour_.
      */
-    void attachVectorElementData(VectorBuffer& buf, std::string name)
+    void attachVectorElementData(VectorBuffer& userBuf, std::string name)
     {
+        VectorBuffer& buf = stageBuffer_(userBuf, curWrite_->vectorBuffers, vectorBufferPool_);
         sanitizeVectorBuffer_(buf);
 
-        using VtkFn = VtkVectorFunction<GridView, ElementMapper>;
-        FunctionPtr fnPtr(new VtkFn(name,
-                                    gridView_,
-                                    elementMapper_,
-                                    buf,
-                                    /*codim=*/0));
-        curWriter_->addCellData(fnPtr);
+        if constexpr (nativeOutput)
+            curWrite_->writer->addVectorCellData(buf, name);
+        else {
+            using VtkFn = VtkVectorFunction<GridView, ElementMapper>;
+            FunctionPtr fnPtr(new VtkFn(name,
+                                        gridView_,
+                                        elementMapper_,
+                                        buf,
+                                        /*codim=*/0));
+            curWrite_->writer->addCellData(fnPtr);
+        }
     }
 
     /*!
      * \brief Add a finished element-centered tensor field to the output.
      */
-    void attachTensorElementData(TensorBuffer& buf, std::string name)
+    void attachTensorElementData(TensorBuffer& userBuf, std::string name)
     {
         using VtkFn = VtkTensorFunction<GridView, ElementMapper>;
+        TensorBuffer& buf = stageBuffer_(userBuf, curWrite_->tensorBuffers, tensorBufferPool_);
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
-            FunctionPtr fnPtr(new VtkFn(oss.str(),
-                                        gridView_,
-                                        elementMapper_,
-                                        buf,
-                                        /*codim=*/0,
-                                        colIdx));
-            curWriter_->addCellData(fnPtr);
+            if constexpr (nativeOutput)
+                curWrite_->writer->addTensorCellData(buf, colIdx, oss.str());
+            else {
+                FunctionPtr fnPtr(new VtkFn(oss.str(),
+                                            gridView_,
+                                            elementMapper_,
+                                            buf,
+                                            /*codim=*/0,
+                                            colIdx));
+                curWrite_->writer->addCellData(fnPtr);
+            }
         }
     }
 
@@ -385,26 +533,41 @@ public:
     void endWrite(bool onlyDiscard = false)
     {
         if (!onlyDiscard) {
-            auto tasklet = std::make_shared<WriteDataTasklet>(*this);
+            {
+                std::lock_guard<std::mutex> lock(pendingWritesMutex_);
+                ++numPendingWrites_;
+            }
+
+            auto tasklet = std::make_shared<WriteDataTasklet>(*this, std::move(curWrite_));
             taskletRunner_.dispatch(tasklet);
         }
-        else
+        else {
+            releaseBuffers_(*curWrite_);
+            curWrite_.reset();
             --curWriterNum_;
-
-        // temporarily write the closing XML mumbo-jumbo to the mashup
-        // file so that the data set can be loaded even if the
-        // simulation is aborted (or not yet finished)
-        finishMultiFile_();
+        }
     }
 
+    /*!
+     * \brief Block until all time steps which have been finalized using endWrite()
+     *        are written to disk.
+     */
+    void waitForPendingWrites()
+    { waitForPendingWrites_(/*maxNum=*/0); }
+
     /*!
      * \brief Write the multi-writer's state to a restart file.
      */
     template <class Restarter>
     void serialize(Restarter& res)
     {
+        // the pending writes modify the multi-file
+        taskletRunner_.barrier();
+
         res.serializeSectionBegin("VTKMultiWriter");
         res.serializeStream() << curWriterNum_ << "\n";
+        if (xdmfContainer_)
+            res.serializeStream() << xdmfContainer_->size() << "\n";
 
         if (commRank_ == 0) {
             std::streamsize fileLen = 0;
@@ -437,8 +600,15 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
+        taskletRunner_.barrier();
+
         res.deserializeSectionBegin("VTKMultiWriter");
         res.deserializeStream() >> curWriterNum_;
+        if (xdmfContainer_) {
+            std::uint64_t containerSize;
+            res.deserializeStream() >> containerSize;
+            xdmfContainer_->setSize(containerSize);
+        }
 
         if (commRank_ == 0) {
             std::string dummy;
@@ -486,7 +656,15 @@ private:
     void startMultiFile_(const std::string& multiFileName)
     {
         // only the first process writes to the multi-file
-        if (commRank_ == 0) {
+        if (commRank_ == 0 && xdmfOutput) {
+            // the time steps are a temporal collection of grids
+            multiFile_.open(multiFileName.c_str());
+            multiFile_ << "<?xml version=\"1.0\"?>\n"
+                          "<Xdmf Version=\"3.0\">\n"
+                          " <Domain>\n"
+                          "  <Grid Name=\"" << simName_ << "\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+        }
+        else if (commRank_ == 0) {
             // generate one meta vtk-file holding the individual time steps
             multiFile_.open(multiFileName.c_str());
             multiFile_ << "<?xml version=\"1.0\"?>\n"
@@ -504,8 +682,13 @@ private:
         if (commRank_ == 0) {
             // make sure that we always have a working meta file
             std::ofstream::pos_type pos = multiFile_.tellp();
-            multiFile_ << " </Collection>\n"
-                          "</VTKFile>\n";
+            if (xdmfOutput)
+                multiFile_ << "  </Grid>\n"
+                              " </Domain>\n"
+                              "</Xdmf>\n";
+            else
+                multiFile_ << " </Collection>\n"
+                              "</VTKFile>\n";
             multiFile_.seekp(pos);
             multiFile_.flush();
         }
@@ -523,20 +706,64 @@ private:
         // nothing to do: this is done by VtkVectorFunction
     }
 
-    // release the memory occupied by all buffer objects managed by the multi-writer
-    void releaseBuffers_()
+    // get a buffer from the pool or allocate a new one if the pool is empty
+    template <class Buffer>
+    Buffer* acquireBuffer_(std::list<Buffer*>& pool)
     {
-        // discard managed objects and the current VTK writer
-        delete curWriter_;
-        curWriter_ = nullptr;
-        while (managedScalarBuffers_.begin() != managedScalarBuffers_.end()) {
-            delete managedScalarBuffers_.front();
-            managedScalarBuffers_.pop_front();
-        }
-        while (managedVectorBuffers_.begin() != managedVectorBuffers_.end()) {
-            delete managedVectorBuffers_.front();
-            managedVectorBuffers_.pop_front();
+        std::lock_guard<std::mutex> lock(pendingWritesMutex_);
+        if (pool.empty())
+            return new Buffer;
+
+        Buffer* buf = pool.front();
+        pool.pop_front();
+        return buf;
+    }
+
+    // return the buffer which is attached to the VTK writer for a buffer passed by the
+    // user. if the data is written asynchronously, buffers which are not managed by
+    // the multi-writer are copied, so that the user may modify them as soon as
+    // endWrite() was called
+    template <class Buffer>
+    Buffer& stageBuffer_(Buffer& userBuf, std::list<Buffer*>& managedBuffers, std::list<Buffer*>& pool)
+    {
+        if (!asyncWriting_
+            || std::find(managedBuffers.begin(), managedBuffers.end(), &userBuf) != managedBuffers.end())
+            return userBuf;
+
+        Buffer* buf = acquireBuffer_(pool);
+        *buf = userBuf;
+        managedBuffers.push_back(buf);
+        return *buf;
+    }
+
+    // move the buffers of a write back to the pools and discard its VTK writer
+    void releaseBuffers_(PendingWrite_& write)
+    {
+        write.writer.reset();
+
+        std::lock_guard<std::mutex> lock(pendingWritesMutex_);
+        scalarBufferPool_.splice(scalarBufferPool_.end(), write.scalarBuffers);
+        vectorBufferPool_.splice(vectorBufferPool_.end(), write.vectorBuffers);
+        tensorBufferPool_.splice(tensorBufferPool_.end(), write.tensorBuffers);
+    }
+
+    // called by the writer thread after the data of a time step has been written
+    void finishPendingWrite_(std::unique_ptr<PendingWrite_> write)
+    {
+        releaseBuffers_(*write);
+
+        {
+            std::lock_guard<std::mutex> lock(pendingWritesMutex_);
+            --numPendingWrites_;
         }
+        pendingWritesCondition_.notify_all();
+    }
+
+    // block until at most maxNum writes are pending
+    void waitForPendingWrites_(unsigned maxNum)
+    {
+        std::unique_lock<std::mutex> lock(pendingWritesMutex_);
+        pendingWritesCondition_.wait(lock, [this, maxNum]() { return numPendingWrites_ <= maxNum; });
     }
 
     const GridView gridView_;
@@ -551,13 +778,22 @@ private:
     int commSize_; // number of processes in the communicator
     int commRank_; // rank of the current process in the communicator
 
-    VtkWriter *curWriter_;
-    double curTime_;
-    std::string curOutFileName_;
+    std::unique_ptr<PendingWrite_> curWrite_;
     int curWriterNum_;
 
-    std::list<ScalarBuffer *> managedScalarBuffers_;
-    std::list<VectorBuffer *> managedVectorBuffers_;
+    bool asyncWriting_;
+    unsigned maxPendingWrites_;
+    unsigned numPendingWrites_;
+    std::mutex pendingWritesMutex_;
+    std::condition_variable pendingWritesCondition_;
+
+    std::list<ScalarBuffer*> scalarBufferPool_;
+    std::list<VectorBuffer*> vectorBufferPool_;
+    std::list<TensorBuffer*> tensorBufferPool_;
+
+    // the grid is encoded only once for all time steps by the native writers
+    std::shared_ptr<VtuMesh> vtuMesh_;
+    std::unique_ptr<XdmfContainer<GridView>> xdmfContainer_;
 
     TaskletRunner taskletRunner_;
 };
@@ -0,0 +1,632 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::VtuWriter
+ */
+#ifndef EWOMS_VTU_WRITER_HH
+#define EWOMS_VTU_WRITER_HH
+
+#include <opm/models/io/baseoutputwriter.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Additional values of the VtkOutputFormat property which select one of the
+ *        native writers instead of Dune::VTKWriter.
+ */
+namespace VtuFormat {
+enum {
+    //! Uncompressed binary data in the appended section of the file
+    appendedRaw = 0x100,
+
+    //! zlib compressed binary data in the appended section of the file
+    appendedCompressed = 0x101,
+
+    //! A single binary file for all time steps which is described by an XDMF file
+    xdmf = 0x102
+};
+} // namespace VtuFormat
+
+/*!
+ * \brief Returns true if a value of the VtkOutputFormat property selects the native
+ *        VTU writer.
+ */
+constexpr bool isNativeVtuFormat(int vtkFormat)
+{ return vtkFormat == VtuFormat::appendedRaw || vtkFormat == VtuFormat::appendedCompressed; }
+
+/*!
+ * \brief The fields which are attached to one of the native output writers.
+ *
+ * The fields only reference the output buffers. Their values are converted to
+ * single precision when the data is written.
+ */
+class NativeOutputFields
+{
+protected:
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    struct Field_
+    {
+        std::string name;
+        bool isCellData;
+        unsigned numComponents;
+        const ScalarBuffer* scalarBuf;
+        const VectorBuffer* vectorBuf;
+        const TensorBuffer* tensorBuf;
+        unsigned tensorColumnIdx;
+    };
+
+public:
+    /*!
+     * \brief Add a vertex-centered scalar field.
+     */
+    void addScalarVertexData(const ScalarBuffer& buf, const std::string& name)
+    { fields_.push_back(Field_{name, /*isCellData=*/false, 1, &buf, nullptr, nullptr, 0}); }
+
+    /*!
+     * \brief Add an element-centered scalar field.
+     */
+    void addScalarCellData(const ScalarBuffer& buf, const std::string& name)
+    { fields_.push_back(Field_{name, /*isCellData=*/true, 1, &buf, nullptr, nullptr, 0}); }
+
+    /*!
+     * \brief Add a vertex-centered vector field.
+     */
+    void addVectorVertexData(const VectorBuffer& buf, const std::string& name)
+    { fields_.push_back(Field_{name, /*isCellData=*/false, numVectorComponents_(buf), nullptr, &buf, nullptr, 0}); }
+
+    /*!
+     * \brief Add an element-centered vector field.
+     */
+    void addVectorCellData(const VectorBuffer& buf, const std::string& name)
+    { fields_.push_back(Field_{name, /*isCellData=*/true, numVectorComponents_(buf), nullptr, &buf, nullptr, 0}); }
+
+    /*!
+     * \brief Add a column of a vertex-centered tensor field.
+     */
+    void addTensorVertexData(const TensorBuffer& buf, unsigned colIdx, const std::string& name)
+    {
+        unsigned numComponents = buf.empty() ? 0 : static_cast<unsigned>(buf[0].M());
+        fields_.push_back(Field_{name, /*isCellData=*/false, numComponents, nullptr, nullptr, &buf, colIdx});
+    }
+
+    /*!
+     * \brief Add a column of an element-centered tensor field.
+     */
+    void addTensorCellData(const TensorBuffer& buf, unsigned colIdx, const std::string& name)
+    {
+        unsigned numComponents = buf.empty() ? 0 : static_cast<unsigned>(buf[0].M());
+        fields_.push_back(Field_{name, /*isCellData=*/true, numComponents, nullptr, nullptr, &buf, colIdx});
+    }
+
+protected:
+    static unsigned numVectorComponents_(const VectorBuffer& buf)
+    {
+        unsigned n = buf.empty() ? 0 : static_cast<unsigned>(buf[0].size());
+        // VTK only considers fields with three components as vectors
+        return (n == 2) ? 3 : n;
+    }
+
+    // the number of single precision values of a field
+    static size_t numFieldValues_(const Field_& field, size_t numVertices, size_t numCells)
+    { return (field.isCellData ? numCells : numVertices)*field.numComponents; }
+
+    // converts the values of a field to single precision directly from its output
+    // buffer, one block at a time. points are read in the order of the vertex mapper
+    // and cells in the order given by cellElementIdx.
+    class FieldReader_
+    {
+    public:
+        FieldReader_(const Field_& field, const std::vector<unsigned>& cellElementIdx)
+            : field_(field)
+            , cellElementIdx_(cellElementIdx)
+            , entityIdx_(0)
+            , compIdx_(0)
+        {}
+
+        // convert the next numValues values and store them at dest
+        void read(char* dest, size_t numValues)
+        {
+            for (size_t i = 0; i < numValues; ++i) {
+                float value = value_();
+                std::memcpy(dest + i*sizeof(float), &value, sizeof(float));
+                if (++compIdx_ == field_.numComponents) {
+                    compIdx_ = 0;
+                    ++entityIdx_;
+                }
+            }
+        }
+
+    private:
+        float value_() const
+        {
+            size_t idx = field_.isCellData ? cellElementIdx_[entityIdx_] : entityIdx_;
+            if (field_.scalarBuf)
+                return static_cast<float>((*field_.scalarBuf)[idx]);
+            else if (field_.vectorBuf) {
+                // two-dimensional vectors are padded to three components
+                const auto& vec = (*field_.vectorBuf)[idx];
+                return compIdx_ < vec.size() ? static_cast<float>(vec[compIdx_]) : 0.0f;
+            }
+            return static_cast<float>((*field_.tensorBuf)[idx][compIdx_][field_.tensorColumnIdx]);
+        }
+
+        const Field_& field_;
+        const std::vector<unsigned>& cellElementIdx_;
+        size_t entityIdx_;
+        unsigned compIdx_;
+    };
+
+    std::vector<Field_> fields_;
+};
+
+/*!
+ * \brief The encoded grid of a VTU file.
+ *
+ * The grid does not depend on the fields which are written, so it can be shared by
+ * the VtuWriter objects of all time steps until the grid changes.
+ */
+struct VtuMesh
+{
+    struct DataArray
+    {
+        std::string attributes;
+        std::vector<char> encoded;
+    };
+
+    bool valid = false;
+    std::vector<DataArray> points;
+    std::vector<DataArray> cells;
+    std::vector<unsigned> cellElementIdx;
+};
+
+/*!
+ * \brief Writes unstructured grid VTK files using the "appended raw" encoding.
+ *
+ * In contrast to Dune::VTKWriter, the fields are not evaluated element-wise
+ * using virtual functions and the data is not converted to text or base64: The
+ * values of each field are converted directly from the output buffers and written
+ * as a contiguous binary block. Without compression, the values are streamed into
+ * the file, otherwise they are compressed block by block using zlib. Points are
+ * written in the order of the vertex mapper, so vertex data is written as is. Cells
+ * are written for the interior elements of the grid view. In parallel, a .pvtu file
+ * which references the pieces of all processes is written by the first rank.
+ *
+ * The encoded grid is only computed once if the same VtuMesh object is passed to the
+ * writers of multiple time steps.
+ */
+template <class GridView, class VertexMapper, class ElementMapper>
+class VtuWriter : public NativeOutputFields
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    // the size of the blocks which are compressed independently (same as VTK)
+    static constexpr size_t compressionBlockSize_ = 32768;
+
+    using DataArray_ = VtuMesh::DataArray;
+
+    // the data array of a field. without compression, the data is not encoded
+    // ahead but streamed into the file from the output buffer.
+    struct FieldArray_
+    {
+        std::string attributes;
+        const Field_* streamedField;
+        std::uint64_t encodedSize;
+        std::vector<char> encoded;
+    };
+
+public:
+    VtuWriter(const GridView& gridView,
+              const VertexMapper& vertexMapper,
+              const ElementMapper& elementMapper,
+              bool compress,
+              std::shared_ptr<VtuMesh> mesh = nullptr)
+        : gridView_(gridView)
+        , vertexMapper_(vertexMapper)
+        , elementMapper_(elementMapper)
+        , compress_(compress)
+        , mesh_(mesh ? mesh : std::make_shared<VtuMesh>())
+    {
+#if !HAVE_ZLIB
+        if (compress_)
+            throw std::runtime_error("Compressed VTU output requires zlib");
+#endif
+    }
+
+    /*!
+     * \brief Write the data of the current process to a .vtu file.
+     *
+     * The signature is the same as the one of Dune::VTKWriter. The output type is
+     * ignored because the encoding is specified in the constructor.
+     *
+     * \return The name of the written file
+     */
+    std::string write(const std::string& name,
+                      Dune::VTK::OutputType type OPM_UNUSED = Dune::VTK::appendedraw)
+    {
+        std::string fileName = name + fileSuffix_();
+        writePiece_(fileName);
+        return fileName;
+    }
+
+    /*!
+     * \brief Write the data of all processes to one .vtu file per process and a
+     *        .pvtu file which references them.
+     *
+     * The signature and the file names are the same as the ones of Dune::VTKWriter.
+     *
+     * \return The name of the written .pvtu file
+     */
+    std::string pwrite(const std::string& name,
+                       const std::string& path,
+                       const std::string& extendPath,
+                       Dune::VTK::OutputType type OPM_UNUSED = Dune::VTK::appendedraw)
+    {
+        std::string dir = path;
+        if (!extendPath.empty())
+            dir += "/" + extendPath;
+        if (!dir.empty() && dir.back() != '/')
+            dir += "/";
+
+        int commSize = gridView_.comm().size();
+        int commRank = gridView_.comm().rank();
+        writePiece_(dir + pieceName_(name, commSize, commRank));
+
+        std::string pvtuFileName = dir + seriesName_(name, commSize) + ".pvtu";
+        if (commRank == 0)
+            writeParallelHeader_(pvtuFileName, name, commSize);
+
+        return pvtuFileName;
+    }
+
+private:
+    static std::string fileSuffix_()
+    { return ".vtu"; }
+
+    static std::string seriesName_(const std::string& name, int commSize)
+    {
+        std::ostringstream oss;
+        oss << "s" << std::setw(4) << std::setfill('0') << commSize << "-" << name;
+        return oss.str();
+    }
+
+    static std::string pieceName_(const std::string& name, int commSize, int commRank)
+    {
+        std::ostringstream oss;
+        oss << "s" << std::setw(4) << std::setfill('0') << commSize
+            << "-p" << std::setw(4) << std::setfill('0') << commRank
+            << "-" << name << fileSuffix_();
+        return oss.str();
+    }
+
+    static const char* byteOrder_()
+    {
+        const std::uint16_t probe = 1;
+        unsigned char firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+        return firstByte == 1 ? "LittleEndian" : "BigEndian";
+    }
+
+    const char* compressorAttribute_() const
+    { return compress_ ? " compressor=\"vtkZLibDataCompressor\"" : ""; }
+
+    // encode a vector of values using the appended binary format of VTK
+    template <class T>
+    std::vector<char> encode_(const std::vector<T>& values) const
+    {
+        const char* data = reinterpret_cast<const char*>(values.data());
+        size_t pos = 0;
+        return encode_(values.size()*sizeof(T),
+                       [data, &pos](char* dest, size_t numBytes)
+                       {
+                           std::memcpy(dest, data + pos, numBytes);
+                           pos += numBytes;
+                       });
+    }
+
+    // encode raw data using the appended binary format of VTK. the data is produced
+    // in consecutive blocks by fillBlock(dest, numBytes), so it does not need to be
+    // available as a contiguous array
+    template <class FillBlock>
+    std::vector<char> encode_(std::uint64_t numBytes, FillBlock fillBlock) const
+    {
+        std::vector<char> result;
+
+        if (!compress_) {
+            result.resize(sizeof(numBytes) + numBytes);
+            std::memcpy(result.data(), &numBytes, sizeof(numBytes));
+            if (numBytes > 0)
+                fillBlock(result.data() + sizeof(numBytes), static_cast<size_t>(numBytes));
+            return result;
+        }
+
+#if HAVE_ZLIB
+        // the header consists of the number of blocks, the size of a block, the size
+        // of the last block and the compressed size of each block
+        std::uint64_t numBlocks = (numBytes + compressionBlockSize_ - 1)/compressionBlockSize_;
+        std::vector<std::uint64_t> header(3 + numBlocks);
+        header[0] = numBlocks;
+        header[1] = compressionBlockSize_;
+        header[2] = (numBlocks > 0 && numBytes % compressionBlockSize_ != 0)
+            ? numBytes % compressionBlockSize_
+            : compressionBlockSize_;
+
+        std::vector<char> compressed;
+        std::vector<char> srcBuf(compressionBlockSize_);
+        std::vector<Bytef> blockBuf(compressBound(compressionBlockSize_));
+        for (std::uint64_t blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+            uLong srcSize = static_cast<uLong>(std::min<std::uint64_t>(compressionBlockSize_,
+                                                                       numBytes - blockIdx*compressionBlockSize_));
+            fillBlock(srcBuf.data(), static_cast<size_t>(srcSize));
+            uLongf dstSize = static_cast<uLongf>(blockBuf.size());
+            int ret = compress2(blockBuf.data(), &dstSize,
+                                reinterpret_cast<const Bytef*>(srcBuf.data()),
+                                srcSize, Z_DEFAULT_COMPRESSION);
+            if (ret != Z_OK)
+                throw std::runtime_error("Could not compress VTU data block");
+
+            header[3 + blockIdx] = dstSize;
+            compressed.insert(compressed.end(), blockBuf.begin(), blockBuf.begin() + dstSize);
+        }
+
+        result.resize(header.size()*sizeof(std::uint64_t) + compressed.size());
+        std::memcpy(result.data(), header.data(), header.size()*sizeof(std::uint64_t));
+        std::copy(compressed.begin(), compressed.end(), result.begin() + header.size()*sizeof(std::uint64_t));
+#endif // HAVE_ZLIB
+
+        return result;
+    }
+
+    // determine the interior elements, their connectivity and the point coordinates
+    void prepareMesh_()
+    {
+        std::vector<float> coords(vertexMapper_.size()*3, 0.0f);
+        auto vIt = gridView_.template begin</*codim=*/dim>();
+        const auto& vEndIt = gridView_.template end</*codim=*/dim>();
+        for (; vIt != vEndIt; ++vIt) {
+            size_t vertexIdx = vertexMapper_.index(*vIt);
+            const auto& pos = vIt->geometry().corner(0);
+            for (unsigned i = 0; i < dimWorld && i < 3; ++i)
+                coords[vertexIdx*3 + i] = static_cast<float>(pos[i]);
+        }
+
+        std::vector<std::int32_t> connectivity;
+        std::vector<std::int32_t> offsets;
+        std::vector<std::uint8_t> types;
+        auto& cellElementIdx = mesh_->cellElementIdx;
+        cellElementIdx.clear();
+        auto elemIt = gridView_.template begin</*codim=*/0, Dune::Interior_Partition>();
+        const auto& elemEndIt = gridView_.template end</*codim=*/0, Dune::Interior_Partition>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const auto& elem = *elemIt;
+            cellElementIdx.push_back(static_cast<unsigned>(elementMapper_.index(elem)));
+
+            const auto& type = elem.type();
+            unsigned numCorners = elem.subEntities(dim);
+            for (unsigned vtkCornerIdx = 0; vtkCornerIdx < numCorners; ++vtkCornerIdx) {
+                int duneCornerIdx = Dune::VTK::renumber(type, static_cast<int>(vtkCornerIdx));
+                connectivity.push_back(static_cast<std::int32_t>(vertexMapper_.subIndex(elem, duneCornerIdx, dim)));
+            }
+            offsets.push_back(static_cast<std::int32_t>(connectivity.size()));
+            types.push_back(static_cast<std::uint8_t>(Dune::VTK::geometryType(type)));
+        }
+
+        mesh_->points.clear();
+        mesh_->points.push_back(DataArray_{"type=\"Float32\" NumberOfComponents=\"3\"", encode_(coords)});
+        mesh_->cells.clear();
+        mesh_->cells.push_back(DataArray_{"type=\"Int32\" Name=\"connectivity\"", encode_(connectivity)});
+        mesh_->cells.push_back(DataArray_{"type=\"Int32\" Name=\"offsets\"", encode_(offsets)});
+        mesh_->cells.push_back(DataArray_{"type=\"UInt8\" Name=\"types\"", encode_(types)});
+        mesh_->valid = true;
+    }
+
+    static void writeDataArrays_(std::ostream& os,
+                                 const std::vector<DataArray_>& arrays,
+                                 std::uint64_t& offset)
+    {
+        for (const auto& array : arrays) {
+            os << "    <DataArray " << array.attributes
+               << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+            offset += array.encoded.size();
+        }
+    }
+
+    static void writeAppendedData_(std::ostream& os, const std::vector<DataArray_>& arrays)
+    {
+        for (const auto& array : arrays)
+            os.write(array.encoded.data(), static_cast<std::streamsize>(array.encoded.size()));
+    }
+
+    FieldArray_ fieldArray_(const Field_& field) const
+    {
+        std::uint64_t numBytes =
+            numFieldValues_(field, vertexMapper_.size(), mesh_->cellElementIdx.size())*sizeof(float);
+        if (!compress_)
+            return FieldArray_{fieldAttributes_(field), &field, sizeof(numBytes) + numBytes, {}};
+
+        FieldReader_ reader(field, mesh_->cellElementIdx);
+        auto encoded = encode_(numBytes,
+                               [&reader](char* dest, size_t numBlockBytes)
+                               { reader.read(dest, numBlockBytes/sizeof(float)); });
+        std::uint64_t encodedSize = encoded.size();
+        return FieldArray_{fieldAttributes_(field), nullptr, encodedSize, std::move(encoded)};
+    }
+
+    static void writeFieldArrays_(std::ostream& os,
+                                  const std::vector<FieldArray_>& arrays,
+                                  std::uint64_t& offset)
+    {
+        for (const auto& array : arrays) {
+            os << "    <DataArray " << array.attributes
+               << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+            offset += array.encodedSize;
+        }
+    }
+
+    void writeAppendedFields_(std::ostream& os, const std::vector<FieldArray_>& arrays) const
+    {
+        std::vector<char> block;
+        for (const auto& array : arrays) {
+            if (!array.streamedField) {
+                os.write(array.encoded.data(), static_cast<std::streamsize>(array.encoded.size()));
+                continue;
+            }
+
+            std::uint64_t numBytes = array.encodedSize - sizeof(std::uint64_t);
+            os.write(reinterpret_cast<const char*>(&numBytes), sizeof(numBytes));
+
+            FieldReader_ reader(*array.streamedField, mesh_->cellElementIdx);
+            block.resize(compressionBlockSize_);
+            for (std::uint64_t pos = 0; pos < numBytes; pos += compressionBlockSize_) {
+                size_t numBlockBytes = static_cast<size_t>(std::min<std::uint64_t>(compressionBlockSize_,
+                                                                                   numBytes - pos));
+                reader.read(block.data(), numBlockBytes/sizeof(float));
+                os.write(block.data(), static_cast<std::streamsize>(numBlockBytes));
+            }
+        }
+    }
+
+    static std::string fieldAttributes_(const Field_& field)
+    {
+        std::ostringstream oss;
+        oss << "type=\"Float32\" Name=\"" << field.name << "\" NumberOfComponents=\""
+            << field.numComponents << "\"";
+        return oss.str();
+    }
+
+    void writePiece_(const std::string& fileName)
+    {
+        if (!mesh_->valid)
+            prepareMesh_();
+        const auto& points = mesh_->points;
+        const auto& cells = mesh_->cells;
+        const auto& cellElementIdx = mesh_->cellElementIdx;
+
+        std::vector<FieldArray_> pointData;
+        std::vector<FieldArray_> cellData;
+        for (const auto& field : fields_) {
+            auto& arrays = field.isCellData ? cellData : pointData;
+            arrays.push_back(fieldArray_(field));
+        }
+
+        std::ofstream os(fileName.c_str(), std::ios::out | std::ios::binary);
+        os << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << byteOrder_()
+           << "\" header_type=\"UInt64\"" << compressorAttribute_() << ">\n"
+           << " <UnstructuredGrid>\n"
+           << "  <Piece NumberOfPoints=\"" << vertexMapper_.size()
+           << "\" NumberOfCells=\"" << cellElementIdx.size() << "\">\n";
+
+        std::uint64_t offset = 0;
+        os << "   <PointData>\n";
+        writeFieldArrays_(os, pointData, offset);
+        os << "   </PointData>\n"
+           << "   <CellData>\n";
+        writeFieldArrays_(os, cellData, offset);
+        os << "   </CellData>\n"
+           << "   <Points>\n";
+        writeDataArrays_(os, points, offset);
+        os << "   </Points>\n"
+           << "   <Cells>\n";
+        writeDataArrays_(os, cells, offset);
+        os << "   </Cells>\n"
+           << "  </Piece>\n"
+           << " </UnstructuredGrid>\n"
+           << " <AppendedData encoding=\"raw\">\n_";
+
+        writeAppendedFields_(os, pointData);
+        writeAppendedFields_(os, cellData);
+        writeAppendedData_(os, points);
+        writeAppendedData_(os, cells);
+
+        os << "\n </AppendedData>\n"
+           << "</VTKFile>\n";
+
+        if (!os.good())
+            throw std::runtime_error("Could not write VTU file '"+fileName+"'");
+    }
+
+    void writeParallelHeader_(const std::string& fileName, const std::string& name, int commSize) const
+    {
+        std::ofstream os(fileName.c_str());
+        os << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"" << byteOrder_()
+           << "\" header_type=\"UInt64\"" << compressorAttribute_() << ">\n"
+           << " <PUnstructuredGrid GhostLevel=\"0\">\n"
+           << "  <PPointData>\n";
+        for (const auto& field : fields_)
+            if (!field.isCellData)
+                os << "   <PDataArray " << fieldAttributes_(field) << "/>\n";
+        os << "  </PPointData>\n"
+           << "  <PCellData>\n";
+        for (const auto& field : fields_)
+            if (field.isCellData)
+                os << "   <PDataArray " << fieldAttributes_(field) << "/>\n";
+        os << "  </PCellData>\n"
+           << "  <PPoints>\n"
+           << "   <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+           << "  </PPoints>\n";
+        for (int rank = 0; rank < commSize; ++rank)
+            os << "  <Piece Source=\"" << pieceName_(name, commSize, rank) << "\"/>\n";
+        os << " </PUnstructuredGrid>\n"
+           << "</VTKFile>\n";
+
+        if (!os.good())
+            throw std::runtime_error("Could not write PVTU file '"+fileName+"'");
+    }
+
+    const GridView gridView_;
+    const VertexMapper& vertexMapper_;
+    const ElementMapper& elementMapper_;
+    bool compress_;
+
+    std::shared_ptr<VtuMesh> mesh_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,505 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::XdmfWriter
+ */
+#ifndef EWOMS_XDMF_WRITER_HH
+#define EWOMS_XDMF_WRITER_HH
+
+#include "vtuwriter.hh"
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#if HAVE_MPI
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief The binary file which holds the data of all time steps of an XDMF time
+ *        series.
+ *
+ * All processes write into the same file: The data of each time step is appended
+ * to the end of the file, where the data of the processes is stored in the order of
+ * their ranks. If MPI is available, the file is written collectively using MPI-IO on
+ * the communicator of the grid. Since this involves collective communication, the
+ * container must only be written by the thread which also communicates for the
+ * grid, i.e., it must not be written asynchronously if more than one process is
+ * involved. The grid is only written for the first time step and after it has
+ * changed.
+ */
+template <class GridView>
+class XdmfContainer
+{
+public:
+    //! The location of the grid of the local process within the file
+    struct MeshInfo
+    {
+        std::uint64_t pointsOffset;
+        std::uint64_t topologyOffset;
+        std::uint64_t topologyLength;
+        std::uint64_t numPoints;
+        std::uint64_t numCells;
+    };
+
+    XdmfContainer(const GridView& gridView, const std::string& fileName)
+        : gridView_(gridView)
+        , fileName_(fileName)
+        , size_(0)
+        , meshValid_(false)
+        , meshInfo_()
+    {}
+
+    /*!
+     * \brief Returns the path of the container file.
+     */
+    const std::string& fileName() const
+    { return fileName_; }
+
+    /*!
+     * \brief Returns the number of bytes which have been written to the file.
+     */
+    std::uint64_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Continue writing at a given position of the file.
+     *
+     * This is used when a simulation is restarted. Since the process which wrote
+     * the grid may have been a different one, the grid is written again for the
+     * next time step.
+     */
+    void setSize(std::uint64_t size)
+    {
+        size_ = size;
+        meshValid_ = false;
+    }
+
+    /*!
+     * \brief Returns true if the grid of the local process has been written.
+     */
+    bool meshValid() const
+    { return meshValid_; }
+
+    /*!
+     * \brief Returns the location of the grid of the local process.
+     */
+    const MeshInfo& meshInfo() const
+    { return meshInfo_; }
+
+    /*!
+     * \brief Specify the location of the grid of the local process.
+     */
+    void setMeshInfo(const MeshInfo& meshInfo)
+    {
+        meshInfo_ = meshInfo;
+        meshValid_ = true;
+    }
+
+    /*!
+     * \brief Make sure that the grid is written again for the next time step.
+     */
+    void gridChanged()
+    { meshValid_ = false; }
+
+    /*!
+     * \brief Append the data of all processes to the file.
+     *
+     * This method must be called by all processes.
+     *
+     * \return The offset of the local data within the file
+     */
+    std::uint64_t append(const std::vector<char>& localData)
+    {
+        const auto& comm = gridView_.comm();
+        std::uint64_t localSize = localData.size();
+        std::uint64_t offset = size_;
+        // the data of the previous time steps is discarded if the file is written
+        // from the beginning
+        bool truncate = (size_ == 0);
+        if (comm.size() == 1)
+            size_ += localSize;
+        else {
+            std::vector<std::uint64_t> sizes(static_cast<size_t>(comm.size()));
+            comm.allgather(&localSize, 1, sizes.data());
+            for (int rank = 0; rank < comm.size(); ++rank) {
+                if (rank < comm.rank())
+                    offset += sizes[static_cast<size_t>(rank)];
+                size_ += sizes[static_cast<size_t>(rank)];
+            }
+        }
+
+        write_(localData, offset, truncate);
+        return offset;
+    }
+
+private:
+    void write_(const std::vector<char>& localData, std::uint64_t offset, bool truncate)
+    {
+#if HAVE_MPI
+        if (gridView_.comm().size() > 1) {
+            const auto& comm = gridView_.comm();
+            MPI_File fileHandle;
+            int ret = MPI_File_open(mpiComm_(comm),
+                                    const_cast<char*>(fileName_.c_str()),
+                                    MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                                    MPI_INFO_NULL,
+                                    &fileHandle);
+            if (ret != MPI_SUCCESS)
+                throw std::runtime_error("Could not open XDMF data file '"+fileName_+"'");
+
+            if (truncate)
+                MPI_File_set_size(fileHandle, 0);
+
+            // the number of elements of an MPI write is an int, so large amounts of
+            // data are written in chunks. since the writes are collective, all
+            // processes must take part in the same number of them.
+            std::uint64_t numChunks = (localData.size() + maxChunkSize_ - 1)/maxChunkSize_;
+            numChunks = comm.max(numChunks);
+            bool success = true;
+            for (std::uint64_t chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+                std::uint64_t chunkBegin = std::min<std::uint64_t>(chunkIdx*maxChunkSize_, localData.size());
+                std::uint64_t chunkEnd = std::min<std::uint64_t>(chunkBegin + maxChunkSize_, localData.size());
+                ret = MPI_File_write_at_all(fileHandle,
+                                            static_cast<MPI_Offset>(offset + chunkBegin),
+                                            const_cast<char*>(localData.data() + chunkBegin),
+                                            static_cast<int>(chunkEnd - chunkBegin),
+                                            MPI_BYTE,
+                                            MPI_STATUS_IGNORE);
+                success = success && (ret == MPI_SUCCESS);
+            }
+            MPI_File_close(&fileHandle);
+            if (!success)
+                throw std::runtime_error("Could not write XDMF data file '"+fileName_+"'");
+            return;
+        }
+#endif
+
+        std::ios_base::openmode mode = std::ios::out | std::ios::binary;
+        if (truncate)
+            mode |= std::ios::trunc;
+        else
+            mode |= std::ios::in;
+
+        std::ofstream os(fileName_.c_str(), mode);
+        os.seekp(static_cast<std::streamoff>(offset));
+        os.write(localData.data(), static_cast<std::streamsize>(localData.size()));
+        if (!os.good())
+            throw std::runtime_error("Could not write XDMF data file '"+fileName_+"'");
+    }
+
+#if HAVE_MPI
+    // the MPI communicator of the grid. grids which are not distributed do not use
+    // an MPI communicator, but they are not written using MPI-IO either.
+    static MPI_Comm mpiComm_(const Dune::CollectiveCommunication<MPI_Comm>& comm)
+    { return comm; }
+
+    template <class Comm>
+    static MPI_Comm mpiComm_(const Comm&)
+    { return MPI_COMM_SELF; }
+#endif
+
+    // the maximum number of bytes written by a single MPI call
+    static constexpr std::uint64_t maxChunkSize_ = 1u << 30;
+
+    const GridView gridView_;
+    std::string fileName_;
+    std::uint64_t size_;
+
+    bool meshValid_;
+    MeshInfo meshInfo_;
+};
+
+/*!
+ * \brief Writes the data of a time step into an XDMF container file.
+ *
+ * The interface for attaching fields is the same as the one of the VtuWriter. Calling
+ * write() appends the data of all processes to the container file and returns the
+ * XDMF description of the time step. The grid is only written if it has not yet
+ * been written to the container.
+ */
+template <class GridView, class VertexMapper, class ElementMapper>
+class XdmfWriter : public NativeOutputFields
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using Container = XdmfContainer<GridView>;
+    using MeshInfo = typename Container::MeshInfo;
+
+    // the number of entries of the descriptor of a process which are not field
+    // offsets
+    static constexpr unsigned numMeshEntries_ = 5;
+
+public:
+    XdmfWriter(const GridView& gridView,
+               const VertexMapper& vertexMapper,
+               const ElementMapper& elementMapper,
+               Container& container)
+        : gridView_(gridView)
+        , vertexMapper_(vertexMapper)
+        , elementMapper_(elementMapper)
+        , container_(container)
+    {}
+
+    /*!
+     * \brief Append the data of the time step to the container file.
+     *
+     * This method must be called by all processes.
+     *
+     * \return The XDMF description of the time step on the first rank, an empty
+     *         string on all others
+     */
+    std::string write(double time)
+    {
+        std::vector<char> data;
+        bool writeMesh = !container_.meshValid();
+        MeshInfo meshInfo = container_.meshInfo();
+
+        std::vector<std::int32_t> topology;
+        collectCells_(writeMesh ? &topology : nullptr);
+        if (writeMesh) {
+            meshInfo.numPoints = vertexMapper_.size();
+            meshInfo.numCells = cellElementIdx_.size();
+            meshInfo.topologyLength = topology.size();
+            meshInfo.pointsOffset = appendData_(data, pointCoordinates_());
+            meshInfo.topologyOffset = appendData_(data, topology);
+        }
+
+        std::vector<std::uint64_t> descriptor(numMeshEntries_ + fields_.size());
+        for (size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx) {
+            descriptor[numMeshEntries_ + fieldIdx] = appendField_(data, fields_[fieldIdx]);
+        }
+
+        // the offsets are relative to the beginning of the local data up to now
+        std::uint64_t baseOffset = container_.append(data);
+        for (size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx)
+            descriptor[numMeshEntries_ + fieldIdx] += baseOffset;
+        if (writeMesh) {
+            meshInfo.pointsOffset += baseOffset;
+            meshInfo.topologyOffset += baseOffset;
+            container_.setMeshInfo(meshInfo);
+        }
+
+        descriptor[0] = meshInfo.pointsOffset;
+        descriptor[1] = meshInfo.topologyOffset;
+        descriptor[2] = meshInfo.topologyLength;
+        descriptor[3] = meshInfo.numPoints;
+        descriptor[4] = meshInfo.numCells;
+
+        // the first rank describes the pieces of all processes
+        const auto& comm = gridView_.comm();
+        std::vector<std::uint64_t> allDescriptors(descriptor.size()*static_cast<size_t>(comm.size()));
+        if (comm.size() == 1)
+            allDescriptors = descriptor;
+        else
+            comm.gather(descriptor.data(), allDescriptors.data(), static_cast<int>(descriptor.size()), /*root=*/0);
+
+        if (comm.rank() != 0)
+            return "";
+
+        return timeStepXml_(time, allDescriptors, comm.size());
+    }
+
+private:
+    // append a block of values to a buffer. returns the offset of the block within
+    // the buffer
+    template <class T>
+    static std::uint64_t appendData_(std::vector<char>& data, const std::vector<T>& values)
+    {
+        std::uint64_t offset = data.size();
+        data.resize(data.size() + values.size()*sizeof(T));
+        if (!values.empty())
+            std::memcpy(data.data() + offset, values.data(), values.size()*sizeof(T));
+        return offset;
+    }
+
+    // convert the values of a field directly into a buffer. returns the offset of
+    // the values within the buffer
+    std::uint64_t appendField_(std::vector<char>& data, const Field_& field) const
+    {
+        std::uint64_t offset = data.size();
+        size_t numValues = numFieldValues_(field, vertexMapper_.size(), cellElementIdx_.size());
+        data.resize(data.size() + numValues*sizeof(float));
+        FieldReader_ reader(field, cellElementIdx_);
+        reader.read(data.data() + offset, numValues);
+        return offset;
+    }
+
+    std::vector<float> pointCoordinates_() const
+    {
+        std::vector<float> coords(vertexMapper_.size()*3, 0.0f);
+        auto vIt = gridView_.template begin</*codim=*/dim>();
+        const auto& vEndIt = gridView_.template end</*codim=*/dim>();
+        for (; vIt != vEndIt; ++vIt) {
+            size_t vertexIdx = vertexMapper_.index(*vIt);
+            const auto& pos = vIt->geometry().corner(0);
+            for (unsigned i = 0; i < dimWorld && i < 3; ++i)
+                coords[vertexIdx*3 + i] = static_cast<float>(pos[i]);
+        }
+
+        return coords;
+    }
+
+    // determine the interior elements and optionally their topology in the "mixed"
+    // format of XDMF
+    void collectCells_(std::vector<std::int32_t>* topology)
+    {
+        cellElementIdx_.clear();
+        auto elemIt = gridView_.template begin</*codim=*/0, Dune::Interior_Partition>();
+        const auto& elemEndIt = gridView_.template end</*codim=*/0, Dune::Interior_Partition>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const auto& elem = *elemIt;
+            cellElementIdx_.push_back(static_cast<unsigned>(elementMapper_.index(elem)));
+            if (!topology)
+                continue;
+
+            const auto& type = elem.type();
+            unsigned numCorners = elem.subEntities(dim);
+            int xdmfType = xdmfCellType_(Dune::VTK::geometryType(type));
+            topology->push_back(xdmfType);
+            // polylines and polygons are followed by their number of corners
+            if (xdmfType == 2 || xdmfType == 3)
+                topology->push_back(static_cast<std::int32_t>(numCorners));
+
+            // XDMF uses the same corner numbering as VTK
+            for (unsigned vtkCornerIdx = 0; vtkCornerIdx < numCorners; ++vtkCornerIdx) {
+                int duneCornerIdx = Dune::VTK::renumber(type, static_cast<int>(vtkCornerIdx));
+                topology->push_back(static_cast<std::int32_t>(vertexMapper_.subIndex(elem, duneCornerIdx, dim)));
+            }
+        }
+    }
+
+    static int xdmfCellType_(Dune::VTK::GeometryType vtkType)
+    {
+        switch (vtkType) {
+        case Dune::VTK::vertex: return 1;
+        case Dune::VTK::line: return 2;
+        case Dune::VTK::polygon: return 3;
+        case Dune::VTK::triangle: return 4;
+        case Dune::VTK::quadrilateral: return 5;
+        case Dune::VTK::tetrahedron: return 6;
+        case Dune::VTK::pyramid: return 7;
+        case Dune::VTK::prism: return 8;
+        case Dune::VTK::hexahedron: return 9;
+        default:
+            throw std::runtime_error("Unsupported element type for XDMF output");
+        }
+    }
+
+    static const char* attributeType_(unsigned numComponents)
+    {
+        switch (numComponents) {
+        case 1: return "Scalar";
+        case 3: return "Vector";
+        case 9: return "Tensor";
+        default: return "Matrix";
+        }
+    }
+
+    std::string dataItemXml_(const char* numberType,
+                             std::uint64_t offset,
+                             const std::string& dimensions) const
+    {
+        // the data file is referenced relative to the XDMF file
+        std::string fileName = container_.fileName();
+        auto sepPos = fileName.rfind('/');
+        if (sepPos != std::string::npos)
+            fileName = fileName.substr(sepPos + 1);
+
+        std::ostringstream oss;
+        oss << "<DataItem Format=\"Binary\" NumberType=\"" << numberType
+            << "\" Precision=\"4\" Endian=\"Native\" Seek=\"" << offset
+            << "\" Dimensions=\"" << dimensions << "\">" << fileName << "</DataItem>";
+        return oss.str();
+    }
+
+    std::string timeStepXml_(double time,
+                             const std::vector<std::uint64_t>& allDescriptors,
+                             int commSize) const
+    {
+        std::ostringstream oss;
+        oss.precision(16);
+        oss << "   <Grid Name=\"step\" GridType=\"Collection\" CollectionType=\"Spatial\">\n"
+            << "    <Time Value=\"" << time << "\"/>\n";
+
+        size_t descriptorSize = numMeshEntries_ + fields_.size();
+        for (int rank = 0; rank < commSize; ++rank) {
+            const std::uint64_t* desc = allDescriptors.data() + static_cast<size_t>(rank)*descriptorSize;
+            std::uint64_t numPoints = desc[3];
+            std::uint64_t numCells = desc[4];
+
+            oss << "    <Grid Name=\"p" << rank << "\" GridType=\"Uniform\">\n"
+                << "     <Topology TopologyType=\"Mixed\" NumberOfElements=\"" << numCells << "\">\n"
+                << "      " << dataItemXml_("Int", desc[1], std::to_string(desc[2])) << "\n"
+                << "     </Topology>\n"
+                << "     <Geometry GeometryType=\"XYZ\">\n"
+                << "      " << dataItemXml_("Float", desc[0], std::to_string(numPoints) + " 3") << "\n"
+                << "     </Geometry>\n";
+
+            for (size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx) {
+                const auto& field = fields_[fieldIdx];
+                std::uint64_t numEntities = field.isCellData ? numCells : numPoints;
+                oss << "     <Attribute Name=\"" << field.name
+                    << "\" AttributeType=\"" << attributeType_(field.numComponents)
+                    << "\" Center=\"" << (field.isCellData ? "Cell" : "Node") << "\">\n"
+                    << "      " << dataItemXml_("Float",
+                                                desc[numMeshEntries_ + fieldIdx],
+                                                std::to_string(numEntities) + " "
+                                                + std::to_string(field.numComponents)) << "\n"
+                    << "     </Attribute>\n";
+            }
+
+            oss << "    </Grid>\n";
+        }
+
+        oss << "   </Grid>\n";
+        return oss.str();
+    }
+
+    const GridView gridView_;
+    const VertexMapper& vertexMapper_;
+    const ElementMapper& elementMapper_;
+    Container& container_;
+
+    std::vector<unsigned> cellElementIdx_;
+};
+
+} // namespace Opm
+
+#endif
@@ -33,6 +33,7 @@
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
 #include <opm/material/densead/Math.hpp>
@@ -45,8 +46,13 @@
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 #include <unistd.h>
 
@@ -125,6 +131,37 @@ struct NewtonTargetIterations { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify whether the tolerance of the linear solver should be chosen for each
+ *        iteration based on the reduction of the error of the Newton method.
+ *
+ * This is the "choice 2" forcing term of Eisenstat and Walker. If it is disabled, the
+ * linear systems are always solved using the LinearSolverTolerance parameter.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonEnableLinearToleranceForcing { using type = UndefinedProperty; };
+
+//! The factor gamma of the forcing term eta_k = gamma*(|F_k|/|F_{k-1}|)^alpha
+template<class TypeTag, class MyTypeTag>
+struct NewtonForcingGamma { using type = UndefinedProperty; };
+
+//! The exponent alpha of the forcing term eta_k = gamma*(|F_k|/|F_{k-1}|)^alpha
+template<class TypeTag, class MyTypeTag>
+struct NewtonForcingAlpha { using type = UndefinedProperty; };
+
+//! The largest tolerance of the linear solver which may be chosen by the forcing term
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxLinearTolerance { using type = UndefinedProperty; };
+
+//! Specify whether the update of the Newton method should be shortened by a
+//! backtracking line search if it does not reduce the error
+template<class TypeTag, class MyTypeTag>
+struct NewtonEnableLineSearch { using type = UndefinedProperty; };
+
+//! The maximum number of times the update is halved by the line search
+template<class TypeTag, class MyTypeTag>
+struct NewtonLineSearchMaxCuts { using type = UndefinedProperty; };
+
 // set default values for the properties
 template<class TypeTag>
 struct NewtonMethod<TypeTag, TTag::NewtonMethod> { using type = ::Opm::NewtonMethod<TypeTag>; };
@@ -152,6 +189,30 @@ template<class TypeTag>
 struct NewtonTargetIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
 template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 18; };
+template<class TypeTag>
+struct NewtonEnableLinearToleranceForcing<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonForcingGamma<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.9;
+};
+template<class TypeTag>
+struct NewtonForcingAlpha<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 2.0;
+};
+template<class TypeTag>
+struct NewtonMaxLinearTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+template<class TypeTag>
+struct NewtonEnableLineSearch<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonLineSearchMaxCuts<TypeTag, TTag::NewtonMethod> { static constexpr int value = 3; };
 
 } // namespace Opm::Properties
 
@@ -184,6 +245,8 @@ class NewtonMethod
     using Communicator = typename Dune::MPIHelper::MPICommunicator;
     using CollectiveCommunication = Dune::CollectiveCommunication<Communicator>;
 
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
 public:
     NewtonMethod(Simulator& simulator)
         : simulator_(simulator)
@@ -194,8 +257,15 @@ public:
     {
         lastError_ = 1e100;
         error_ = 1e100;
+        linearizationSucceeded_ = true;
+        eqErrors_ = 1e100;
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonTolerance);
 
+        // the tolerance specified for the linear solver is used if the forcing term is
+        // disabled and as the lower bound of the forcing term otherwise.
+        tightLinearTolerance_ = linearSolver_.linearSolverTolerance();
+        linearTolerance_ = tightLinearTolerance_;
+
         numIterations_ = 0;
     }
 
@@ -225,6 +295,24 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonEnableLinearToleranceForcing,
+                             "Choose the tolerance of the linear solver for each Newton "
+                             "iteration based on the reduction of the error");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonForcingGamma,
+                             "The factor of the forcing term which determines the "
+                             "tolerance of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonForcingAlpha,
+                             "The exponent of the forcing term which determines the "
+                             "tolerance of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxLinearTolerance,
+                             "The largest tolerance of the linear solver which may be "
+                             "chosen by the forcing term");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonEnableLineSearch,
+                             "Shorten the Newton update using a backtracking line search "
+                             "if it does not reduce the error");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonLineSearchMaxCuts,
+                             "The maximum number of times the Newton update is halved by "
+                             "the line search");
     }
 
     /*!
@@ -243,6 +331,15 @@ public:
     bool converged() const
     { return error_ <= tolerance(); }
 
+    /*!
+     * \brief Returns the maximum weighted residual of each equation for the most
+     *        recent iteration.
+     *
+     * The error of the solution is the maximum of these values.
+     */
+    const EqVector& equationErrors() const
+    { return eqErrors_; }
+
     /*!
      * \brief Returns a reference to the object describing the current physical problem.
      */
@@ -298,6 +395,13 @@ public:
     void setTolerance(Scalar value)
     { tolerance_ = value; }
 
+    /*!
+     * \brief Return the tolerance of the linear solver which was used for the most
+     *        recent linear solve.
+     */
+    Scalar linearTolerance() const
+    { return linearTolerance_; }
+
     /*!
      * \brief Run the Newton method.
      *
@@ -351,6 +455,15 @@ public:
                 asImp_().beginIteration_();
                 prePostProcessTimer_.stop();
 
+                // give the implementation the chance to improve the solution before
+                // the global system of equations is considered
+                updateTimer_.start();
+                {
+                    ProfilerRegion region("solve subdomains");
+                    asImp_().solveSubdomains_(nextSolution);
+                }
+                updateTimer_.stop();
+
                 // make the current solution to the old one
                 currentSolution = nextSolution;
 
@@ -362,23 +475,32 @@ public:
 
                 // do the actual linearization
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                {
+                    ProfilerRegion region("linearize");
+                    asImp_().linearizeDomain_();
+                    asImp_().linearizeAuxiliaryEquations_();
+                }
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
                 auto& residual = linearizer.residual();
                 const auto& jacobian = linearizer.jacobian();
-                linearSolver_.prepare(jacobian, residual);
-                linearSolver_.setResidual(residual);
-                linearSolver_.getResidual(residual);
+                {
+                    ProfilerRegion region("prepare linear solver");
+                    linearSolver_.prepare(jacobian, residual);
+                    linearSolver_.setResidual(residual);
+                    linearSolver_.getResidual(residual);
+                }
                 solveTimer_.stop();
 
                 // The preSolve_() method usually computes the errors, but it can do
                 // something else in addition. TODO: should its costs be counted to
                 // the linearization or to the update?
                 updateTimer_.start();
-                asImp_().preSolve_(currentSolution, residual);
+                {
+                    ProfilerRegion region("convergence check");
+                    asImp_().preSolve_(currentSolution, residual);
+                }
                 updateTimer_.stop();
 
                 if (!asImp_().proceed_()) {
@@ -404,9 +526,15 @@ public:
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                linearSolver_.setMatrix(jacobian);
-                solutionUpdate = 0.0;
-                bool converged = linearSolver_.solve(solutionUpdate);
+                bool converged;
+                {
+                    ProfilerRegion region("linear solve");
+                    if (EWOMS_GET_PARAM(TypeTag, bool, NewtonEnableLinearToleranceForcing)) {
+                        linearTolerance_ = asImp_().forcingTerm_();
+                        linearSolver_.setLinearSolverTolerance(linearTolerance_);
+                    }
+                    converged = asImp_().solveLinearSystem_(jacobian, residual, solutionUpdate);
+                }
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -431,10 +559,17 @@ public:
                 // update the current solution (i.e. uOld) with the delta
                 // (i.e. u). The result is stored in u
                 updateTimer_.start();
-                asImp_().postSolve_(currentSolution,
-                                    residual,
-                                    solutionUpdate);
-                asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                {
+                    ProfilerRegion region("update");
+                    asImp_().postSolve_(currentSolution,
+                                        residual,
+                                        solutionUpdate);
+                    asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                }
+                if (EWOMS_GET_PARAM(TypeTag, bool, NewtonEnableLineSearch)) {
+                    ProfilerRegion region("line search");
+                    asImp_().lineSearch_(nextSolution, currentSolution, solutionUpdate, residual);
+                }
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -600,6 +735,9 @@ protected:
     {
         numIterations_ = 0;
 
+        // the weights of the residual do not change within a time step
+        asImp_().updateErrorWeights_();
+
         if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
     }
@@ -632,13 +770,26 @@ protected:
         lastError_ = error_;
     }
 
+    /*!
+     * \brief Solve local non-linear problems before each global iteration.
+     *
+     * This is intended for nonlinear preconditioners like domain decomposition
+     * methods. The default implementation does nothing.
+     *
+     * \param nextSolution The solution which is to be improved
+     */
+    void solveSubdomains_(SolutionVector& nextSolution  OPM_UNUSED)
+    { }
+
     /*!
      * \brief Linearize the global non-linear system of equations associated with the
      *        spatial domain.
      */
     void linearizeDomain_()
     {
-        model().linearizer().linearizeDomain();
+        // whether all processes succeeded is determined by the reduction of the errors
+        // in preSolve_()
+        linearizationSucceeded_ = model().linearizer().linearizeDomainLocally();
     }
 
     void linearizeAuxiliaryEquations_()
@@ -650,31 +801,13 @@ protected:
     void preSolve_(const SolutionVector& currentSolution  OPM_UNUSED,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
         Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
 
-        // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
-
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
-        }
-
-        // take the other processes into account
-        error_ = comm_.max(error_);
+        if (!asImp_().computeErrors_(currentResidual, eqErrors_, error_,
+                                     /*localFailure=*/!linearizationSucceeded_))
+            throw NumericalIssue("Newton: A process did not succeed in linearizing the "
+                                 "system or the residual contains non-finite values");
 
         // make sure that the error never grows beyond the maximum
         // allowed one
@@ -684,6 +817,178 @@ protected:
                                   +std::to_string(double(newtonMaxError)));
     }
 
+    /*!
+     * \brief Calculate the maximum weighted residual of each equation and the error,
+     *        i.e., the maximum of these values, for a given residual.
+     *
+     * This is done in a single pass over the degrees of freedom and a single
+     * reduction over all processes. Auxiliary DOFs are not considered because no
+     * weights are stored for them.
+     *
+     * \param localFailure Specifies that the residual could not be computed on the
+     *                     current process. This is combined with the errors into the
+     *                     same reduction.
+     * \return false if the residual contains non-finite values or if any process
+     *         reported a failure, else true.
+     */
+    bool computeErrors_(const GlobalEqVector& residual,
+                        EqVector& eqErrors,
+                        Scalar& error,
+                        bool localFailure = false) const
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+        const bool checkConstraints = enableConstraints_() && !constraintsMap.empty();
+
+        // the last entry of the metrics is non-zero if a non-finite value was
+        // encountered or if the residual could not be computed.
+        std::array<Scalar, numEq + 1> metrics;
+        metrics.fill(0.0);
+        if (localFailure)
+            metrics[numEq] = 1.0;
+
+        const unsigned numWeightedDof = static_cast<unsigned>(errorWeights_.size());
+        std::mutex mutex;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            std::array<Scalar, numEq + 1> threadMetrics;
+            threadMetrics.fill(0.0);
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (unsigned dofIdx = 0; dofIdx < numWeightedDof; ++dofIdx) {
+                // do not consider DOFs which are constraint
+                if (checkConstraints && constraintsMap.count(dofIdx) > 0)
+                    continue;
+
+                const auto& r = residual[dofIdx];
+                const auto& weights = errorWeights_[dofIdx];
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    if (weights[eqIdx] == 0.0)
+                        continue;
+
+                    Scalar err = std::abs(r[eqIdx]*weights[eqIdx]);
+                    if (!std::isfinite(err))
+                        threadMetrics[numEq] = 1.0;
+                    else
+                        threadMetrics[eqIdx] = std::max(threadMetrics[eqIdx], err);
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(mutex);
+            for (unsigned i = 0; i < numEq + 1; ++i)
+                metrics[i] = std::max(metrics[i], threadMetrics[i]);
+        }
+
+        // take the other processes into account using a single reduction
+        comm_.max(metrics.data(), numEq + 1);
+
+        error = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            eqErrors[eqIdx] = metrics[eqIdx];
+            error = std::max(error, metrics[eqIdx]);
+        }
+
+        return metrics[numEq] == 0.0;
+    }
+
+    /*!
+     * \brief Compute the weights of the residual which are used to calculate the error.
+     *
+     * This is called at the beginning of each time step. DOFs which do not have a
+     * volume get weights of zero, i.e., they are not considered.
+     */
+    void updateErrorWeights_()
+    {
+        size_t numGridDof = model().numGridDof();
+        errorWeights_.resize(numGridDof);
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            auto& weights = errorWeights_[dofIdx];
+            if (model().dofTotalVolume(dofIdx) <= 0.0) {
+                weights = 0.0;
+                continue;
+            }
+
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                weights[eqIdx] = asImp_().errorWeight_(dofIdx, eqIdx);
+        }
+    }
+
+    /*!
+     * \brief Returns the weight of an equation of a DOF for the error of the solution.
+     *
+     * Equations with a weight of zero are not considered for the error.
+     */
+    Scalar errorWeight_(unsigned globalDofIdx, unsigned eqIdx) const
+    { return model().eqWeight(globalDofIdx, eqIdx); }
+
+    /*!
+     * \brief Returns the tolerance of the linear solver for the current iteration.
+     *
+     * This uses the "choice 2" forcing term of Eisenstat and Walker, i.e.,
+     * \f[ \eta_k = \gamma \left(\frac{\|F(x^k)\|}{\|F(x^{k-1})\|}\right)^\alpha \f]
+     * with their safeguard against decreasing the tolerance too quickly. The result is
+     * limited to the range between the LinearSolverTolerance and the
+     * NewtonMaxLinearTolerance parameters. If the next iterate is expected to be
+     * converged, the system is solved using the LinearSolverTolerance so that the
+     * final solution corresponds to the one obtained without the forcing term.
+     *
+     * For details, see
+     *
+     * S. Eisenstat, H. Walker: "Choosing the Forcing Terms in an Inexact Newton
+     * Method", SIAM J. Sci. Comput. 17, pp. 16-32, 1996
+     */
+    Scalar forcingTerm_() const
+    {
+        Scalar maxTol = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxLinearTolerance);
+
+        // there is no previous error within the current time step
+        if (numIterations_ == 0)
+            return std::max(maxTol, tightLinearTolerance_);
+
+        // solve accurately if the error is expected to drop below the tolerance in
+        // the current iteration
+        Scalar ratio = error_/lastError_;
+        if (error_*ratio < tolerance())
+            return tightLinearTolerance_;
+
+        Scalar gamma = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonForcingGamma);
+        Scalar alpha = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonForcingAlpha);
+        Scalar eta = gamma*std::pow(ratio, alpha);
+
+        // safeguard of Eisenstat and Walker: do not tighten a large tolerance of the
+        // previous iteration abruptly
+        Scalar safeguard = gamma*std::pow(linearTolerance_, alpha);
+        if (safeguard > 0.1)
+            eta = std::max(eta, safeguard);
+
+        return std::max(std::min(eta, maxTol), tightLinearTolerance_);
+    }
+
+    /*!
+     * \brief Solve the linear system of equations of the current iteration.
+     *
+     * The right hand side has already been passed to the linear solver when this
+     * method is called. Splitting schemes can override this method to solve a
+     * modified system instead.
+     *
+     * \param jacobian The Jacobian matrix of the residual
+     * \param currentResidual The residual of the current iteration's solution
+     * \param solutionUpdate Receives the solution of the linear system
+     * \return true if the linear solver converged
+     */
+    template <class Jacobian>
+    bool solveLinearSystem_(const Jacobian& jacobian,
+                            const GlobalEqVector& currentResidual OPM_UNUSED,
+                            GlobalEqVector& solutionUpdate)
+    {
+        linearSolver_.setMatrix(jacobian);
+        solutionUpdate = 0.0;
+        return linearSolver_.solve(solutionUpdate);
+    }
+
     /*!
      * \brief Update the error of the solution given the previous
      *        iteration.
@@ -787,6 +1092,75 @@ protected:
         }
     }
 
+    /*!
+     * \brief Shorten the update of the current iteration if it does not sufficiently
+     *        reduce the error.
+     *
+     * The residual of the updated solution is evaluated without linearizing it. If the
+     * error is not reduced by the update or if the residual cannot be evaluated for the
+     * updated solution, the update is halved and re-applied using update_(), i.e., the
+     * model-specific chopping of the update is still effective.
+     * After at most NewtonLineSearchMaxCuts halvings, the shortest update is accepted.
+     * The line search is skipped if the model features auxiliary equations because
+     * their residual cannot be evaluated on its own.
+     *
+     * \param nextSolution The solution vector after the current iteration
+     * \param currentSolution The solution vector after the last iteration
+     * \param solutionUpdate The delta vector as calculated by solving the linear system
+     *                       of equations
+     * \param currentResidual The residual vector of the current Newton-Raphson iteraton
+     */
+    void lineSearch_(SolutionVector& nextSolution,
+                     const SolutionVector& currentSolution,
+                     const GlobalEqVector& solutionUpdate,
+                     const GlobalEqVector& currentResidual)
+    {
+        if (model().numAuxiliaryModules() > 0)
+            return;
+
+        // the parameter of the Armijo condition
+        static constexpr Scalar armijoFactor = 1e-4;
+
+        auto& linearizer = model().linearizer();
+        int maxCuts = EWOMS_GET_PARAM(TypeTag, int, NewtonLineSearchMaxCuts);
+        Scalar lambda = 1.0;
+        int numCuts = 0;
+        EqVector trialEqErrors;
+        for (; ; ++numCuts) {
+            // a trial solution for which the residual cannot be evaluated, e.g. because
+            // it is not physical, is rejected like one which does not reduce the error
+            Scalar trialError = 0.0;
+            bool isFinite;
+            try {
+                trialResidual_.resize(currentResidual.size());
+                linearizer.evaluateResidual(trialResidual_);
+
+                // add the contributions of the peer processes to the residual
+                linearSolver_.setResidual(trialResidual_);
+                linearSolver_.getResidual(trialResidual_);
+
+                isFinite = asImp_().computeErrors_(trialResidual_, trialEqErrors, trialError);
+            }
+            catch (const NumericalIssue&) {
+                isFinite = false;
+            }
+
+            if (isFinite && trialError <= (1.0 - armijoFactor*lambda)*error_)
+                break;
+            if (numCuts >= maxCuts)
+                break;
+
+            lambda /= 2.0;
+            scaledUpdate_ = solutionUpdate;
+            scaledUpdate_ *= lambda;
+            asImp_().update_(nextSolution, currentSolution, scaledUpdate_, currentResidual);
+        }
+
+        Profiler::addToCounter("line search cuts", static_cast<double>(numCuts));
+        if (numCuts > 0)
+            endIterMsg() << ", line search: " << lambda;
+    }
+
     /*!
      * \brief Update the primary variables for a degree of freedom which is constraint.
      */
@@ -932,6 +1306,24 @@ protected:
     Scalar lastError_;
     Scalar tolerance_;
 
+    // specifies whether the most recent linearization succeeded on the current process
+    bool linearizationSucceeded_;
+
+    // the tolerance of the linear solver specified by the user and the one which was
+    // used for the most recent iteration
+    Scalar tightLinearTolerance_;
+    Scalar linearTolerance_;
+
+    // the maximum weighted residual of each equation for the last iteration
+    EqVector eqErrors_;
+
+    // the weights of the equations of each grid DOF used to calculate the error
+    std::vector<EqVector> errorWeights_;
+
+    // the residual of the trial solutions and the shortened update of the line search
+    GlobalEqVector trialResidual_;
+    GlobalEqVector scaledUpdate_;
+
     // actual number of iterations done so far
     int numIterations_;
 
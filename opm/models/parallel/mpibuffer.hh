@@ -31,6 +31,8 @@
 #include <mpi.h>
 #endif
 
+#include <opm/models/utils/profiler.hh>
+
 #include <stddef.h>
 
 #include <type_traits>
@@ -85,6 +87,7 @@ public:
     void send([[maybe_unused]] unsigned peerRank)
     {
 #if HAVE_MPI
+        Profiler::addToCounter("bytes sent", static_cast<double>(dataSize_*sizeof(DataType)));
         MPI_Isend(data_,
                   static_cast<int>(mpiDataSize_),
                   mpiDataType_,
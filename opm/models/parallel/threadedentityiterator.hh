@@ -89,6 +89,20 @@ public:
         return tmp;
     }
 
+    // claims a chunk of at most maxSize consecutive entities which are not yet worked
+    // on by any thread. returns the first entity of the chunk, the number of entities
+    // in the chunk is stored in the size argument.
+    EntityIterator incrementChunk(unsigned maxSize, unsigned& size)
+    {
+        mutex_.lock();
+        auto tmp = sequentialIt_;
+        for (size = 0; size < maxSize && sequentialIt_ != sequentialEnd_; ++size)
+            ++sequentialIt_;
+        mutex_.unlock();
+
+        return tmp;
+    }
+
 private:
     GridView gridView_;
     EntityIterator sequentialIt_;
@@ -36,6 +36,10 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
 namespace Opm {
 
 /*!
@@ -62,6 +66,9 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, ThreadsPerProcess,
                              "The maximum number of threads to be instantiated per process "
                              "('-1' means 'automatic')");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NumaDomains,
+                             "The number of NUMA domains across which the threads of a "
+                             "process are spread");
     }
 
     static void init()
@@ -95,6 +102,12 @@ public:
 
         numThreads_ = omp_get_max_threads();
 #endif
+
+        int numNumaDomains = EWOMS_GET_PARAM(TypeTag, int, NumaDomains);
+        if (numNumaDomains < 1)
+            throw std::invalid_argument("The number of NUMA domains must be at least 1, but it is "
+                                        +std::to_string(numNumaDomains)+"!");
+        numNumaDomains_ = std::min(numNumaDomains, numThreads_);
     }
 
     /*!
@@ -115,12 +128,31 @@ public:
 #endif
     }
 
+    /*!
+     * \brief Return the number of NUMA domains across which the threads are spread.
+     */
+    static unsigned numNumaDomains()
+    { return static_cast<unsigned>(numNumaDomains_); }
+
+    /*!
+     * \brief Return the index of the NUMA domain of the current OpenMP thread
+     *
+     * This assumes that the threads are bound to the cores in the order of their
+     * indices (e.g., by setting OMP_PROC_BIND=close), so that the threads of a domain
+     * exhibit consecutive indices.
+     */
+    static unsigned numaDomain()
+    { return threadId()*numNumaDomains()/maxThreads(); }
+
 private:
     static int numThreads_;
+    static int numNumaDomains_;
 };
 
 template <class TypeTag>
 int ThreadManager<TypeTag>::numThreads_ = 1;
+template <class TypeTag>
+int ThreadManager<TypeTag>::numNumaDomains_ = 1;
 } // namespace Opm
 
 #endif
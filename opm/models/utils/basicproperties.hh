@@ -128,6 +128,48 @@ struct PrintProperties { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct PrintParameters { using type = UndefinedProperty; };
 
+/*!
+ * \brief Print how often each run-time parameter was retrieved at the end of the
+ *        simulation?
+ *
+ * This helps to find parameters which are retrieved in the inner loops of the
+ * simulator. The default is false.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PrintParameterReads { using type = UndefinedProperty; };
+
+/*!
+ * \brief Print the number of bytes which the model requires per degree of freedom
+ *        after the simulator has been set up?
+ *
+ * The default is false.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PrintMemoryFootprint { using type = UndefinedProperty; };
+
+/*!
+ * \brief Record the time spent in the regions of the simulator which are instrumented
+ *        using Opm::ProfilerRegion?
+ *
+ * The statistics of the regions are written to the file specified by the
+ * ProfilingOutputFile property at the end of the simulation. The default is false.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableProfiling { using type = UndefinedProperty; };
+
+//! The name of the JSON file to which the profiling statistics are written
+template<class TypeTag, class MyTypeTag>
+struct ProfilingOutputFile { using type = UndefinedProperty; };
+
+/*!
+ * \brief The name of the file to which the individual invocations of the profiled
+ *        regions are written in the Chrome trace event format.
+ *
+ * If this is empty, no trace is recorded.
+ */
+template<class TypeTag, class MyTypeTag>
+struct ProfilingTraceFile { using type = UndefinedProperty; };
+
 //! The default value for the simulation's end time
 template<class TypeTag, class MyTypeTag>
 struct EndTime { using type = UndefinedProperty; };
@@ -140,6 +182,22 @@ struct InitialTimeStepSize { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct RestartTime { using type = UndefinedProperty; };
 
+//! Specify whether restart files are written in the binary format
+template<class TypeTag, class MyTypeTag>
+struct EnableBinaryRestart { using type = UndefinedProperty; };
+
+//! Specify whether restart files are written by a separate thread
+template<class TypeTag, class MyTypeTag>
+struct EnableAsyncRestart { using type = UndefinedProperty; };
+
+//! The number of time steps after which a restart file is written
+template<class TypeTag, class MyTypeTag>
+struct RestartWriteInterval { using type = UndefinedProperty; };
+
+//! The wall clock time after which a restart file is written
+template<class TypeTag, class MyTypeTag>
+struct RestartWriteWallTimeInterval { using type = UndefinedProperty; };
+
 //! The name of the file with a number of forced time step lengths
 template<class TypeTag, class MyTypeTag>
 struct PredeterminedTimeStepsFile { using type = UndefinedProperty; };
@@ -246,6 +304,24 @@ struct PrintProperties<TypeTag, TTag::NumericModel> { static constexpr int value
 template<class TypeTag>
 struct PrintParameters<TypeTag, TTag::NumericModel> { static constexpr int value = 2; };
 
+//! By default, the number of times the parameters were retrieved is not printed
+template<class TypeTag>
+struct PrintParameterReads<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, the memory footprint of the model is not printed
+template<class TypeTag>
+struct PrintMemoryFootprint<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, the simulator is not profiled
+template<class TypeTag>
+struct EnableProfiling<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+template<class TypeTag>
+struct ProfilingOutputFile<TypeTag, TTag::NumericModel> { static constexpr auto value = "profile.json"; };
+
+template<class TypeTag>
+struct ProfilingTraceFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
 //! The default value for the simulation's end time
 template<class TypeTag>
 struct EndTime<TypeTag, TTag::NumericModel>
@@ -270,6 +346,25 @@ struct RestartTime<TypeTag, TTag::NumericModel>
     static constexpr type value = -1e35;
 };
 
+//! By default, restart files are human readable
+template<class TypeTag>
+struct EnableBinaryRestart<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, restart files are written synchronously
+template<class TypeTag>
+struct EnableAsyncRestart<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, only the problem decides when restart files are written
+template<class TypeTag>
+struct RestartWriteInterval<TypeTag, TTag::NumericModel> { static constexpr int value = 0; };
+
+template<class TypeTag>
+struct RestartWriteWallTimeInterval<TypeTag, TTag::NumericModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
 //! By default, do not force any time steps
 template<class TypeTag>
 struct PredeterminedTimeStepsFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
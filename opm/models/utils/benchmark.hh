@@ -0,0 +1,570 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Provides a driver which measures the performance of the numerical hot paths
+ *        of a simulator instead of running the simulation.
+ */
+#ifndef EWOMS_BENCHMARK_HH
+#define EWOMS_BENCHMARK_HH
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/io/restart.hh>
+#include <opm/models/io/vtkmultiwriter.hh>
+
+#include <opm/common/utility/FileSystem.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bvector.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Opm::Properties {
+
+//! The number of times each benchmark is repeated
+template<class TypeTag, class MyTypeTag>
+struct BenchmarkRepetitions { using type = UndefinedProperty; };
+
+/*!
+ * \brief A comma separated list of the numbers of threads for which the linearization
+ *        is measured.
+ *
+ * If this is empty, only the number of threads specified by the ThreadsPerProcess
+ * property is considered.
+ */
+template<class TypeTag, class MyTypeTag>
+struct BenchmarkThreadCounts { using type = UndefinedProperty; };
+
+//! The file to which the results of the benchmarks are appended
+template<class TypeTag, class MyTypeTag>
+struct BenchmarkOutputFile { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct BenchmarkRepetitions<TypeTag, TTag::NumericModel> { static constexpr int value = 10; };
+
+template<class TypeTag>
+struct BenchmarkThreadCounts<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
+template<class TypeTag>
+struct BenchmarkOutputFile<TypeTag, TTag::NumericModel> { static constexpr auto value = "benchmark.jsonl"; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Measures the performance of the numerical hot paths of a simulator.
+ *
+ * The simulator is set up as usual, i.e., the grid can be scaled using the run-time
+ * parameters of the vanguard, but instead of running the simulation, the following
+ * operations are timed for the initial solution:
+ *
+ * - the linearization of the spatial domain for each of the requested numbers of
+ *   threads (elements per second)
+ * - the scatter of local Jacobian blocks into the global matrix (bytes per second)
+ * - the sparse matrix-vector product with the Jacobian matrix (bytes per second)
+ * - the solution of the linearized system with the linear solver of the model
+ * - the synchronization of the overlap and ghost degrees of freedom
+ * - writing the VTK output and restart files
+ *
+ * Each benchmark is executed once to warm up the caches and is then repeated. The
+ * minimum and the mean time of the repetitions are reported. For operations which
+ * involve multiple processes, the time of the slowest one counts.
+ *
+ * The results are printed and appended to a file in the JSON Lines format, i.e., one
+ * self-contained JSON object per measurement. Comparing the files of two versions thus
+ * allows to spot performance regressions.
+ */
+template <class TypeTag>
+class BenchmarkRunner
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
+    using IstlVector = Dune::BlockVector<Dune::FieldVector<typename MatrixBlock::field_type,
+                                                           MatrixBlock::rows>>;
+    using Clock = std::chrono::steady_clock;
+
+    static const int vtkOutputFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
+    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkOutputFormat>;
+
+    using ExtraValues = std::vector<std::pair<std::string, double>>;
+
+    struct Timing
+    {
+        double min;
+        double mean;
+    };
+
+public:
+    /*!
+     * \brief Register all run-time parameters of the benchmark driver.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, int, BenchmarkRepetitions,
+                             "The number of times each benchmark is repeated");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, BenchmarkThreadCounts,
+                             "A comma separated list of the numbers of threads for which "
+                             "the linearization is measured");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, BenchmarkOutputFile,
+                             "The file to which the results of the benchmarks are appended "
+                             "in the JSON Lines format");
+    }
+
+    explicit BenchmarkRunner(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        numRepetitions_ = static_cast<unsigned>(std::max(1, EWOMS_GET_PARAM(TypeTag, int, BenchmarkRepetitions)));
+        outputFileName_ = EWOMS_GET_PARAM(TypeTag, std::string, BenchmarkOutputFile);
+
+        const auto& gridView = simulator_.gridView();
+        double numLocalInterior = 0;
+        for (const auto& elem : elements(gridView))
+            if (elem.partitionType() == Dune::InteriorEntity)
+                ++ numLocalInterior;
+        numInterior_ = gridView.comm().sum(numLocalInterior);
+        numRanks_ = gridView.comm().size();
+    }
+
+    /*!
+     * \brief Run all benchmarks.
+     */
+    void run()
+    {
+        if (isRoot_()) {
+            std::cout << "Benchmarking '" << simulator_.problem().name() << "' with "
+                      << numInterior_ << " elements on " << numRanks_ << " process(es)\n"
+                      << std::flush;
+            simulator_.model().printMemoryFootprint(std::cout);
+        }
+
+        for (unsigned numThreads : threadCounts_())
+            benchmarkLinearization_(numThreads);
+        setNumThreads_(ThreadManager::maxThreads());
+
+        benchmarkScatter_();
+        benchmarkSpmv_();
+        benchmarkLinearSolve_();
+        benchmarkOverlapSync_();
+        benchmarkVtkOutput_();
+        benchmarkRestart_();
+    }
+
+private:
+    void benchmarkLinearization_(unsigned numThreads)
+    {
+        setNumThreads_(numThreads);
+
+        auto& linearizer = simulator_.model().linearizer();
+        Timing t = measure_([&linearizer]() { linearizer.linearizeDomain(); });
+        // the order of the elements is recorded so that the runs with and without
+        // --enable-element-reordering can be told apart
+        double reordered = simulator_.model().elementOrdering().empty() ? 0.0 : 1.0;
+        report_("linearize", numThreads, t,
+                {{"elements", numInterior_},
+                 {"elementsPerSecond", numInterior_/t.min},
+                 {"elementReordering", reordered}});
+    }
+
+    void benchmarkScatter_()
+    {
+        // collect the pairs of degrees of freedom which are coupled by the local
+        // Jacobians of the elements in the same way as FvBaseLinearizer
+        std::vector<std::pair<unsigned, unsigned>> couplings;
+        ElementContext elemCtx(simulator_);
+        for (const auto& elem : elements(simulator_.gridView())) {
+            if (elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            elemCtx.updateStencil(elem);
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++primaryDofIdx) {
+                unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
+                for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++dofIdx)
+                    couplings.emplace_back(elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0), globI);
+            }
+        }
+
+        auto& jacobian = simulator_.model().linearizer().jacobian();
+        MatrixBlock block(0.0);
+        Timing t = measure_([&jacobian, &couplings, &block]() {
+            for (const auto& coupling : couplings)
+                jacobian.addToBlock(coupling.first, coupling.second, block);
+        });
+
+        // each block is read and written
+        double bytes = sum_(2.0*sizeof(MatrixBlock)*static_cast<double>(couplings.size()));
+        report_("scatter", /*numThreads=*/1, t,
+                {{"blocks", sum_(static_cast<double>(couplings.size()))},
+                 {"bytesPerSecond", bytes/t.min}});
+    }
+
+    void benchmarkSpmv_()
+    {
+        const IstlMatrix& matrix = simulator_.model().linearizer().jacobian().istlMatrix();
+        IstlVector x(matrix.M());
+        IstlVector y(matrix.N());
+        x = 1.0;
+
+        Timing t = measure_([&matrix, &x, &y]() { matrix.mv(x, y); });
+
+        // the matrix blocks and their column indices are streamed from memory, while
+        // each block of the vectors is ideally accessed only once
+        double nnz = static_cast<double>(matrix.nonzeroes());
+        double bytes =
+            nnz*(sizeof(MatrixBlock) + sizeof(typename IstlMatrix::size_type))
+            + static_cast<double>(matrix.N() + matrix.M())*sizeof(typename IstlVector::block_type);
+        report_("spmv", /*numThreads=*/1, t,
+                {{"nonzeroBlocks", sum_(nnz)},
+                 {"bytesPerSecond", sum_(bytes)/t.min}});
+    }
+
+    void benchmarkLinearSolve_()
+    {
+        auto& model = simulator_.model();
+        auto& linearizer = model.linearizer();
+        auto& linearSolver = model.newtonMethod().linearSolver();
+
+        linearizer.linearizeDomain();
+        linearizer.linearizeAuxiliaryEquations();
+        linearizer.finalize();
+
+        GlobalEqVector residual(linearizer.residual());
+        GlobalEqVector x(residual.size());
+        double numIterations = 0.0;
+        bool converged = true;
+        Timing t = measure_([&]() {
+            const auto& jacobian = linearizer.jacobian();
+            linearSolver.prepare(jacobian, residual);
+            linearSolver.setResidual(residual);
+            linearSolver.setMatrix(jacobian);
+            x = 0.0;
+            converged = linearSolver.solve(x) && converged;
+            numIterations = static_cast<double>(linearSolver.iterations());
+        });
+
+        report_("linear solve", /*numThreads=*/1, t,
+                {{"converged", converged ? 1.0 : 0.0},
+                 {"iterations", numIterations},
+                 {"secondsPerIteration", t.min/std::max(numIterations, 1.0)}});
+    }
+
+    void benchmarkOverlapSync_()
+    {
+        auto& model = simulator_.model();
+        Timing t = measure_([&model]() { model.syncOverlap(); });
+
+        // the primary variables of all degrees of freedom which are not touched by an
+        // interior element are received from their owners
+        double numReceived = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < model.dofMapper().size(); ++dofIdx)
+            if (!model.isLocalDof(dofIdx))
+                numReceived += 1.0;
+        double bytes = sum_(numReceived*sizeof(PrimaryVariables));
+        report_("overlap sync", /*numThreads=*/1, t,
+                {{"bytes", bytes},
+                 {"bytesPerSecond", bytes/t.min}});
+    }
+
+    void benchmarkVtkOutput_()
+    {
+        const auto& gridView = simulator_.gridView();
+        auto& model = simulator_.model();
+
+        // the files are written to a temporary directory which is removed afterwards
+        const std::string outputDir = createTemporaryDirectory_();
+        {
+            bool asyncVtkOutput =
+                gridView.comm().size() == 1 &&
+                EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncVtkOutput);
+            VtkMultiWriter writer(asyncVtkOutput, gridView, outputDir,
+                                  simulator_.problem().name(),
+                                  /*multiFileName=*/"",
+                                  EWOMS_GET_PARAM(TypeTag, unsigned, VtkOutputQueueSize));
+
+            double time = simulator_.time();
+            Timing t = measure_([&writer, &model, time]() {
+                writer.beginWrite(time);
+                model.prepareOutputFields();
+                model.appendOutputFields(writer);
+                writer.endWrite();
+
+                // with asynchronous output, endWrite() only stages the data
+                writer.waitForPendingWrites();
+            });
+            report_("vtk output", /*numThreads=*/1, t, {});
+        }
+
+        gridView.comm().barrier();
+        if (isRoot_())
+            filesystem::remove_all(outputDir);
+    }
+
+    // create a new directory within the output directory on the first process and
+    // tell its name to all other processes
+    std::string createTemporaryDirectory_() const
+    {
+        const auto& comm = simulator_.gridView().comm();
+
+        std::vector<char> dirName;
+        int nameLength = 0;
+        if (isRoot_()) {
+            std::string pattern = simulator_.problem().outputDir() + "/benchmark-XXXXXX";
+            dirName.assign(pattern.begin(), pattern.end());
+            dirName.push_back('\0');
+            if (!mkdtemp(dirName.data()))
+                dirName.clear();
+            nameLength = static_cast<int>(dirName.size());
+        }
+
+        comm.broadcast(&nameLength, 1, /*root=*/0);
+        if (nameLength == 0)
+            throw std::runtime_error("Could not create a temporary directory for the benchmark");
+
+        dirName.resize(static_cast<size_t>(nameLength));
+        comm.broadcast(dirName.data(), nameLength, /*root=*/0);
+        return std::string(dirName.data());
+    }
+
+    void benchmarkRestart_()
+    {
+        bool binary = EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart);
+        std::string fileName;
+        Timing t = measure_([this, binary, &fileName]() {
+            Restart res(binary);
+            res.serializeBegin(simulator_);
+            simulator_.serialize(res);
+            simulator_.problem().serialize(res);
+            simulator_.model().serialize(res);
+            res.serializeEnd();
+            fileName = res.fileName();
+        });
+
+        double bytes = 0.0;
+        {
+            std::ifstream is(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+            if (is)
+                bytes = static_cast<double>(is.tellg());
+        }
+        std::remove(fileName.c_str());
+
+        bytes = sum_(bytes);
+        report_("restart", /*numThreads=*/1, t,
+                {{"binary", binary ? 1.0 : 0.0},
+                 {"bytes", bytes},
+                 {"bytesPerSecond", bytes/t.min}});
+    }
+
+    // run a function once for warming up and then the requested number of times
+    template <class Fn>
+    Timing measure_(Fn fn)
+    {
+        const auto& comm = simulator_.gridView().comm();
+
+        fn();
+
+        Timing result{std::numeric_limits<double>::max(), 0.0};
+        for (unsigned i = 0; i < numRepetitions_; ++i) {
+            comm.barrier();
+            Clock::time_point start = Clock::now();
+            fn();
+            double dt = std::chrono::duration<double>(Clock::now() - start).count();
+            dt = comm.max(dt);
+
+            result.min = std::min(result.min, dt);
+            result.mean += dt/numRepetitions_;
+        }
+
+        return result;
+    }
+
+    void report_(const std::string& name,
+                 unsigned numThreads,
+                 const Timing& t,
+                 const ExtraValues& extraValues)
+    {
+        if (!isRoot_())
+            return;
+
+        std::cout << "  " << std::left << std::setw(16) << name
+                  << " threads=" << numThreads
+                  << " min=" << t.min << "s"
+                  << " mean=" << t.mean << "s";
+        for (const auto& value : extraValues)
+            std::cout << " " << value.first << "=" << value.second;
+        std::cout << "\n" << std::flush;
+
+        std::ofstream os(outputFileName_, std::ios::out | std::ios::app);
+        if (!os)
+            throw std::runtime_error("Could not open benchmark output file '"+outputFileName_+"'");
+
+        os.precision(9);
+        os << "{\"problem\": " << jsonString_(simulator_.problem().name()) << ", "
+           << "\"benchmark\": " << jsonString_(name) << ", "
+           << "\"ranks\": " << numRanks_ << ", "
+           << "\"threads\": " << numThreads << ", "
+           << "\"repetitions\": " << numRepetitions_ << ", "
+           << "\"minTime\": " << t.min << ", "
+           << "\"meanTime\": " << t.mean;
+        for (const auto& value : extraValues)
+            os << ", " << jsonString_(value.first) << ": " << value.second;
+        os << "}\n";
+    }
+
+    // quote a string and escape the characters which are not allowed in JSON strings
+    static std::string jsonString_(const std::string& value)
+    {
+        std::ostringstream oss;
+        oss << '"';
+        for (char c : value) {
+            if (c == '"' || c == '\\')
+                oss << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<int>(c) << std::dec << std::setfill(' ');
+            else
+                oss << c;
+        }
+        oss << '"';
+        return oss.str();
+    }
+
+    std::vector<unsigned> threadCounts_() const
+    {
+        std::vector<unsigned> result;
+        std::istringstream iss(EWOMS_GET_PARAM(TypeTag, std::string, BenchmarkThreadCounts));
+        std::string token;
+        while (std::getline(iss, token, ',')) {
+            int numThreads = std::stoi(token);
+            if (numThreads < 1 || static_cast<unsigned>(numThreads) > ThreadManager::maxThreads())
+                throw std::invalid_argument("Cannot benchmark "+token+" threads: The number of threads "
+                                            "must be between 1 and the value of "
+                                            "--threads-per-process");
+            result.push_back(static_cast<unsigned>(numThreads));
+        }
+
+        if (result.empty())
+            result.push_back(ThreadManager::maxThreads());
+        return result;
+    }
+
+    static void setNumThreads_([[maybe_unused]] unsigned numThreads)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(static_cast<int>(numThreads));
+#endif
+    }
+
+    double sum_(double localValue) const
+    { return simulator_.gridView().comm().sum(localValue); }
+
+    bool isRoot_() const
+    { return simulator_.gridView().comm().rank() == 0; }
+
+    Simulator& simulator_;
+    unsigned numRepetitions_;
+    std::string outputFileName_;
+    double numInterior_;
+    int numRanks_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Set up a simulator and measure the performance of its numerical hot paths.
+ *
+ * This accepts the same command line arguments as Opm::start() plus the ones of
+ * Opm::BenchmarkRunner.
+ *
+ * \tparam TypeTag  The type tag of the problem which needs to be benchmarked
+ *
+ * \param argc The number of command line arguments
+ * \param argv The array of the command line arguments
+ */
+template <class TypeTag>
+static inline int benchmark(int argc, char **argv)
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+
+    resetLocale();
+
+    int myRank = 0;
+    try
+    {
+        registerAllParameters_<TypeTag>(/*finalizeRegistration=*/false);
+        BenchmarkRunner<TypeTag>::registerParameters();
+        EWOMS_END_PARAM_REGISTRATION(TypeTag);
+
+        int setupStatus = setupSimulatorEnvironment_<TypeTag>(argc, argv,
+                                                              /*requireEndTime=*/false,
+                                                              myRank);
+        if (setupStatus == 1)
+            return 1;
+        if (setupStatus == 2)
+            return 0;
+
+        Simulator simulator(/*verbose=*/false);
+        simulator.model().applyInitialSolution();
+
+        BenchmarkRunner<TypeTag> runner(simulator);
+        runner.run();
+
+        return 0;
+    }
+    catch (std::exception& e)
+    {
+        if (myRank == 0)
+            std::cout << e.what() << ". Abort!\n" << std::flush;
+
+        return 1;
+    }
+}
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,123 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Implements the reverse Cuthill-McKee ordering of a graph.
+ */
+#ifndef EWOMS_CUTHILL_MCKEE_HH
+#define EWOMS_CUTHILL_MCKEE_HH
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Computes the reverse Cuthill-McKee ordering of an undirected graph.
+ *
+ * The graph is given as adjacency lists, i.e., adjacency[i] contains the indices of all
+ * neighbors of node i. The result is a vector which contains the index of the node that
+ * should be visited at each position of the new ordering, i.e., result[k] is the
+ * original index of the k-th node. Disconnected components are handled one after the
+ * other and each of them is started at a node of minimal degree.
+ *
+ * Visiting the nodes in this order reduces the bandwidth of the adjacency matrix, so
+ * the data of neighboring nodes ends up close together in memory.
+ */
+template <class AdjacencyList>
+std::vector<unsigned> reverseCuthillMcKee(const AdjacencyList& adjacency)
+{
+    size_t numNodes = adjacency.size();
+
+    std::vector<unsigned> ordering;
+    ordering.reserve(numNodes);
+
+    // sort the nodes by their degree. this is used to determine the starting node of
+    // each connected component
+    std::vector<unsigned> nodesByDegree(numNodes);
+    for (unsigned nodeIdx = 0; nodeIdx < numNodes; ++nodeIdx)
+        nodesByDegree[nodeIdx] = nodeIdx;
+    std::stable_sort(nodesByDegree.begin(), nodesByDegree.end(),
+                     [&adjacency](unsigned a, unsigned b)
+                     { return adjacency[a].size() < adjacency[b].size(); });
+
+    std::vector<bool> visited(numNodes, false);
+    std::vector<unsigned> neighbors;
+    for (unsigned startIdx : nodesByDegree) {
+        if (visited[startIdx])
+            continue;
+
+        // breadth-first search of the component, where the neighbors of each node
+        // are visited in the order of ascending degree
+        size_t queueIdx = ordering.size();
+        ordering.push_back(startIdx);
+        visited[startIdx] = true;
+        for (; queueIdx < ordering.size(); ++queueIdx) {
+            neighbors.clear();
+            for (unsigned neighborIdx : adjacency[ordering[queueIdx]]) {
+                if (!visited[neighborIdx]) {
+                    visited[neighborIdx] = true;
+                    neighbors.push_back(neighborIdx);
+                }
+            }
+
+            std::stable_sort(neighbors.begin(), neighbors.end(),
+                             [&adjacency](unsigned a, unsigned b)
+                             { return adjacency[a].size() < adjacency[b].size(); });
+            ordering.insert(ordering.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+
+    std::reverse(ordering.begin(), ordering.end());
+    return ordering;
+}
+
+/*!
+ * \brief Returns the bandwidth of the adjacency matrix of a graph if its nodes are
+ *        visited in a given order.
+ *
+ * \param adjacency The adjacency lists of the graph
+ * \param ordering The original index of the node at each position of the ordering
+ */
+template <class AdjacencyList>
+size_t graphBandwidth(const AdjacencyList& adjacency, const std::vector<unsigned>& ordering)
+{
+    std::vector<unsigned> position(ordering.size());
+    for (unsigned k = 0; k < ordering.size(); ++k)
+        position[ordering[k]] = k;
+
+    size_t result = 0;
+    for (unsigned nodeIdx = 0; nodeIdx < adjacency.size(); ++nodeIdx)
+        for (unsigned neighborIdx : adjacency[nodeIdx])
+            result = std::max<size_t>(result,
+                                      std::abs(static_cast<long>(position[nodeIdx])
+                                               - static_cast<long>(position[neighborIdx])));
+
+    return result;
+}
+
+} // namespace Opm
+
+#endif
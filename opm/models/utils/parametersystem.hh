@@ -43,7 +43,12 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
 #include <map>
+#include <mutex>
 #include <set>
 #include <list>
 #include <sstream>
@@ -51,6 +56,7 @@
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
+#include <vector>
 
 #include <unistd.h>
 #include <sys/ioctl.h>
@@ -103,7 +109,9 @@
  *
  * \brief Retrieve a runtime parameter.
  *
- * The default value is specified via the property system.
+ * The default value is specified via the property system. Each call site keeps a
+ * Opm::Parameters::CachedParam object, i.e., the value is only parsed from the
+ * parameter tree on the first call and afterwards retrieving it is cheap.
  *
  * Example:
  *
@@ -114,8 +122,11 @@
  * \endcode
  */
 #define EWOMS_GET_PARAM(TypeTag, ParamType, ParamName)                         \
-    (::Opm::Parameters::get<TypeTag, ParamType>(#ParamName, #ParamName, \
-                                                getPropValue<TypeTag, Properties::ParamName>()))
+    ([]() -> ParamType {                                                       \
+        static ::Opm::Parameters::CachedParam<TypeTag, ParamType> cachedParam( \
+            #ParamName, #ParamName, getPropValue<TypeTag, Properties::ParamName>()); \
+        return cachedParam.get();                                              \
+    }())
 
 //!\cond SKIP_THIS
 #define EWOMS_GET_PARAM_(TypeTag, ParamType, ParamName)                 \
@@ -255,12 +266,56 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    /*!
+     * \brief The generation of the parameter values.
+     *
+     * It is incremented whenever the values might have changed. Values that were
+     * cached for a previous generation need to be retrieved again.
+     */
+    static unsigned generation()
+    { return storage_().generation.load(std::memory_order_acquire); }
+
+    static void invalidateCachedValues()
+    { ++storage_().generation; }
+
+    /*!
+     * \brief Specifies whether the number of reads of each parameter is recorded.
+     */
+    static std::atomic<bool>& countReads()
+    { return storage_().countReads; }
+
+    /*!
+     * \brief Returns the counter for the number of reads of a parameter.
+     *
+     * The counters are kept if the parameters are cleared because they are
+     * referenced by the cached parameters of the call sites.
+     */
+    static std::atomic<unsigned long>& readCounter(const std::string& paramName)
+    {
+        std::lock_guard<std::mutex> lock(storage_().readCountersMutex);
+        return storage_().readCounters[paramName];
+    }
+
+    /*!
+     * \brief Returns a snapshot of the number of reads of each parameter.
+     */
+    static std::map<std::string, unsigned long> readCounters()
+    {
+        std::lock_guard<std::mutex> lock(storage_().readCountersMutex);
+
+        std::map<std::string, unsigned long> result;
+        for (const auto& counter : storage_().readCounters)
+            result[counter.first] = counter.second.load();
+        return result;
+    }
+
     static void clear()
     {
         storage_().tree.reset(new Dune::ParameterTree());
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        invalidateCachedValues();
     }
 
 private:
@@ -273,12 +328,19 @@ private:
         {
             tree.reset(new Dune::ParameterTree());
             registrationOpen = true;
+            generation = 0;
+            countReads = false;
         }
 
         std::unique_ptr<Dune::ParameterTree> tree;
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
         bool registrationOpen;
+
+        std::atomic<unsigned> generation;
+        std::atomic<bool> countReads;
+        std::map<std::string, std::atomic<unsigned long> > readCounters;
+        std::mutex readCountersMutex;
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -688,6 +750,7 @@ std::string parseCommandLineOptions(int argc,
                                     const PositionalArgumentCallback& posArgCallback = noPositionalParameters_)
 {
     Dune::ParameterTree& paramTree = GetProp<TypeTag, Properties::ParameterMetaData>::tree();
+    GetProp<TypeTag, Properties::ParameterMetaData>::invalidateCachedValues();
 
     // handle the "--help" parameter
     if (!helpPreamble.empty()) {
@@ -793,6 +856,7 @@ template <class TypeTag>
 void parseParameterFile(const std::string& fileName, bool overwrite = true)
 {
     Dune::ParameterTree& paramTree = GetProp<TypeTag, Properties::ParameterMetaData>::tree();
+    GetProp<TypeTag, Properties::ParameterMetaData>::invalidateCachedValues();
 
     std::set<std::string> seenKeys;
     std::ifstream ifs(fileName);
@@ -1112,6 +1176,113 @@ const ParamType get(const char *propTagName, const char *paramName, const ParamT
     return Param<TypeTag>::template get<ParamType>(propTagName, paramName, defaultValue, errorIfNotRegistered);
 }
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief A run-time parameter whose value is only parsed once.
+ *
+ * The value is retrieved from the parameter tree on the first call of get() and
+ * stored. Subsequent calls only compare the generation of the stored value with the
+ * one of the parameter system, so they are cheap enough for the innermost loops of
+ * a simulation. If the parameters are cleared or parsed again, the value is
+ * retrieved anew.
+ */
+template <class TypeTag, class ParamType>
+class CachedParam
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    // generation of a value which has not yet been retrieved
+    static constexpr unsigned invalidGeneration_ = std::numeric_limits<unsigned>::max();
+
+public:
+    CachedParam(const char *propTagName,
+                const char *paramName,
+                const ParamType& defaultValue)
+        : propTagName_(propTagName)
+        , paramName_(paramName)
+        , defaultValue_(defaultValue)
+        , value_(defaultValue)
+        , generation_(invalidGeneration_)
+        , numReads_(ParamsMeta::readCounter(paramName))
+    {}
+
+    /*!
+     * \brief Returns the value of the parameter.
+     */
+    ParamType get()
+    {
+        if (ParamsMeta::countReads().load(std::memory_order_relaxed))
+            numReads_.fetch_add(1, std::memory_order_relaxed);
+
+        if (generation_.load(std::memory_order_acquire) != ParamsMeta::generation())
+            update_();
+
+        return value_;
+    }
+
+private:
+    void update_()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unsigned generation = ParamsMeta::generation();
+        if (generation_.load(std::memory_order_relaxed) == generation)
+            return; // another thread was faster
+
+        value_ = Param<TypeTag>::template get<ParamType>(propTagName_, paramName_, defaultValue_);
+        generation_.store(generation, std::memory_order_release);
+    }
+
+    const char *propTagName_;
+    const char *paramName_;
+    ParamType defaultValue_;
+
+    ParamType value_;
+    std::atomic<unsigned> generation_;
+    std::mutex mutex_;
+    std::atomic<unsigned long>& numReads_;
+};
+
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Enable or disable recording how often each parameter is retrieved using
+ *        EWOMS_GET_PARAM().
+ */
+template <class TypeTag>
+void setCountReads(bool yesno)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+    ParamsMeta::countReads() = yesno;
+}
+
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Print how often the parameters have been retrieved.
+ *
+ * Parameters which are retrieved very often are usually accessed from within the
+ * loops over the grid or from the linear solver and should better be retrieved
+ * once by the caller. Reads are only recorded if setCountReads() was enabled.
+ */
+template <class TypeTag>
+void printReadCounts(std::ostream& os = std::cout)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    std::vector<std::pair<unsigned long, std::string> > counts;
+    for (const auto& counter : ParamsMeta::readCounters()) {
+        if (counter.second > 0)
+            counts.emplace_back(counter.second, counter.first);
+    }
+    std::sort(counts.begin(), counts.end(), std::greater<std::pair<unsigned long, std::string> >());
+
+    os << "# Number of times each run-time parameter was retrieved:\n";
+    for (const auto& count : counts)
+        os << count.second << ": " << count.first << "\n";
+    os << std::flush;
+}
+
 template <class TypeTag, class Container>
 void getLists(Container& usedParams, Container& unusedParams)
 {
@@ -0,0 +1,678 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Profiler
+ */
+#ifndef EWOMS_PROFILER_HH
+#define EWOMS_PROFILER_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Collects the time spent in named, nested regions of the code and the values of
+ *        named counters.
+ *
+ * Regions are usually opened using a ProfilerRegion object. Each thread records its
+ * own tree of regions, i.e., the time of a region is attributed to the path of the
+ * regions which enclose it on the same thread. The regions of the parent path which
+ * a worker thread opens on behalf of the thread that spawned it only determine the
+ * path; their time is only recorded by the thread which opened them itself. At the
+ * end of the simulation, the trees of all threads of all processes are merged and
+ * written as a JSON summary. For each region, it contains the time summed over all
+ * threads ("time"), the wall time of the slowest process ("wallTime"), the minimum,
+ * maximum and mean time over the threads and the same statistics over the processes,
+ * where the time of a process is the one of its slowest thread, i.e., it approximates
+ * the wall time. Optionally, the individual invocations of the regions can also be
+ * written in the trace event format which is understood by chrome://tracing and
+ * Perfetto.
+ *
+ * If the profiler is not enabled, opening and closing a region only tests a single
+ * flag.
+ */
+class Profiler
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Node_
+    {
+        const char *name;
+        unsigned parentIdx;
+        double time;
+        unsigned long numCalls;
+        std::vector<unsigned> childIdx;
+    };
+
+    struct TraceEvent_
+    {
+        const char *name;
+        double begin; // [us] since the profiler was enabled
+        double duration; // [us]
+    };
+
+    struct ThreadData_
+    {
+        unsigned threadIdx;
+        std::vector<Node_> nodes;
+        unsigned curNodeIdx;
+        std::vector<Clock::time_point> startTimes;
+        std::vector<bool> traced;
+        std::vector<bool> inherited;
+        std::vector<TraceEvent_> traceEvents;
+        std::map<std::string, double> counters;
+
+        void reset()
+        {
+            nodes.clear();
+            nodes.push_back(Node_{"", /*parentIdx=*/0, /*time=*/0.0, /*numCalls=*/0, {}});
+            curNodeIdx = 0;
+            startTimes.clear();
+            traced.clear();
+            inherited.clear();
+            traceEvents.clear();
+            counters.clear();
+        }
+    };
+
+    struct Storage_
+    {
+        std::atomic<bool> enabled{false};
+        bool traceEvents = false;
+        Clock::time_point epoch = Clock::now();
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadData_>> threadData;
+    };
+
+public:
+    //! The names of the regions which enclose the current point of execution
+    using RegionPath = std::vector<const char *>;
+
+    /*!
+     * \brief Returns true if regions and counters are currently recorded.
+     */
+    static bool enabled()
+    { return storage_().enabled.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Start recording regions and counters.
+     *
+     * \param traceEvents If true, the individual invocations of the regions are also
+     *                    recorded, so that writeChromeTrace() can be used.
+     */
+    static void enable(bool traceEvents = false)
+    {
+        auto& storage = storage_();
+        storage.traceEvents = traceEvents;
+        storage.epoch = Clock::now();
+        storage.enabled.store(true, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Stop recording regions and counters.
+     *
+     * The data which was recorded so far is kept.
+     */
+    static void disable()
+    { storage_().enabled.store(false, std::memory_order_relaxed); }
+
+    /*!
+     * \brief Discard all data which was recorded so far.
+     *
+     * This must not be called while a region is open on any thread.
+     */
+    static void reset()
+    {
+        auto& storage = storage_();
+        std::lock_guard<std::mutex> lock(storage.mutex);
+        for (auto& threadData : storage.threadData)
+            threadData->reset();
+        storage.epoch = Clock::now();
+    }
+
+    /*!
+     * \brief Open a region on the calling thread.
+     *
+     * The name must stay valid until the profiling data was written, i.e., it is
+     * usually a string literal.
+     *
+     * \param traced If false, the region is not recorded as individual trace events
+     *               even if tracing is enabled. This is intended for fine grained
+     *               regions like the ones for single elements.
+     */
+    static void beginRegion(const char *name, bool traced = true)
+    {
+        if (enabled())
+            beginRegion_(name, traced, /*inherited=*/false);
+    }
+
+    /*!
+     * \brief Close the region which was opened last on the calling thread.
+     */
+    static void endRegion()
+    {
+        if (enabled())
+            endRegion_();
+    }
+
+    /*!
+     * \brief Returns the names of the regions which are currently open on the calling
+     *        thread.
+     *
+     * This is intended to be passed to the ProfilerRegion objects of the worker threads
+     * of a parallel block, so that their regions are attributed to the same path as the
+     * ones of the thread which spawned them.
+     */
+    static RegionPath currentPath()
+    {
+        RegionPath result;
+        if (!enabled())
+            return result;
+
+        const ThreadData_& data = threadData_();
+        for (unsigned nodeIdx = data.curNodeIdx; nodeIdx != 0; nodeIdx = data.nodes[nodeIdx].parentIdx)
+            result.push_back(data.nodes[nodeIdx].name);
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    /*!
+     * \brief Add a value to a named counter of the calling thread.
+     *
+     * Counters are intended for quantities like the number of linearized elements or
+     * the number of bytes which were sent to peer processes. Since the counters are
+     * looked up by their name, they should not be incremented in the innermost loops.
+     */
+    static void addToCounter(const char *name, double value)
+    {
+        if (!enabled())
+            return;
+
+        threadData_().counters[name] += value;
+    }
+
+    /*!
+     * \brief Write the statistics of all regions and counters as JSON.
+     *
+     * This is a collective operation: The data of all processes is sent to the process
+     * of rank 0 which is the only one that writes to the stream.
+     */
+    static void writeJson(std::ostream& os)
+    {
+        // each record is "path time numCalls" or "#counter value"
+        std::ostringstream oss;
+        oss.precision(17);
+        {
+            auto& storage = storage_();
+            std::lock_guard<std::mutex> lock(storage.mutex);
+            for (const auto& threadData : storage.threadData) {
+                writeRecords_(oss, *threadData, /*nodeIdx=*/0, /*path=*/"");
+                for (const auto& counter : threadData->counters)
+                    oss << "#" << counter.first << "\t" << counter.second << "\n";
+                oss << "@\n"; // end of the thread's data
+            }
+        }
+
+        std::vector<std::string> rankRecords = gatherOnRankZero_(oss.str());
+        if (rankRecords.empty())
+            return;
+
+        using Stats = std::vector<double>;
+        struct RegionStats { Stats threadTimes; Stats rankTimes; unsigned long numCalls = 0; };
+        std::map<std::string, RegionStats> regionStats;
+        std::map<std::string, Stats> counterStats;
+        unsigned numRanks = static_cast<unsigned>(rankRecords.size());
+        for (unsigned rankIdx = 0; rankIdx < numRanks; ++rankIdx) {
+            std::map<std::string, double> rankTime;
+            std::map<std::string, double> rankCounter;
+            std::istringstream iss(rankRecords[rankIdx]);
+            std::string line;
+            while (std::getline(iss, line)) {
+                if (line.empty() || line[0] == '@')
+                    continue;
+
+                size_t tabPos = line.find('\t');
+                if (line[0] == '#') {
+                    rankCounter[line.substr(1, tabPos - 1)] += std::stod(line.substr(tabPos + 1));
+                    continue;
+                }
+
+                std::string path = line.substr(0, tabPos);
+                std::istringstream valueStream(line.substr(tabPos + 1));
+                double time;
+                unsigned long numCalls;
+                valueStream >> time >> numCalls;
+
+                auto& stats = regionStats[path];
+                stats.threadTimes.push_back(time);
+                stats.numCalls += numCalls;
+                // the threads of a process run concurrently, so the slowest one
+                // determines the time of the process
+                rankTime[path] = std::max(rankTime[path], time);
+            }
+
+            for (const auto& t : rankTime)
+                regionStats[t.first].rankTimes.push_back(t.second);
+            for (const auto& c : rankCounter)
+                counterStats[c.first].push_back(c.second);
+        }
+
+        os.precision(9);
+        os << "{\n"
+           << "  \"numRanks\": " << numRanks << ",\n"
+           << "  \"regions\": [";
+        bool first = true;
+        for (const auto& region : regionStats) {
+            const std::string& path = region.first;
+            const auto& stats = region.second;
+            size_t slashPos = path.rfind('/');
+            os << (first?"":",") << "\n"
+               << "    {\"path\": \"" << jsonEscape_(path) << "\", "
+               << "\"name\": \"" << jsonEscape_(slashPos == std::string::npos ? path : path.substr(slashPos + 1)) << "\", "
+               << "\"depth\": " << std::count(path.begin(), path.end(), '/') << ", "
+               << "\"calls\": " << stats.numCalls << ", "
+               << "\"time\": " << sum_(stats.threadTimes) << ", "
+               << "\"wallTime\": " << *std::max_element(stats.rankTimes.begin(), stats.rankTimes.end()) << ",\n"
+               << "     \"threads\": ";
+            writeStats_(os, stats.threadTimes);
+            os << ",\n     \"ranks\": ";
+            writeStats_(os, stats.rankTimes, numRanks);
+            os << "}";
+            first = false;
+        }
+        os << "\n  ],\n"
+           << "  \"counters\": [";
+        first = true;
+        for (const auto& counter : counterStats) {
+            os << (first?"":",") << "\n"
+               << "    {\"name\": \"" << jsonEscape_(counter.first) << "\", "
+               << "\"total\": " << sum_(counter.second) << ", "
+               << "\"ranks\": ";
+            writeStats_(os, counter.second, numRanks);
+            os << "}";
+            first = false;
+        }
+        os << "\n  ]\n"
+           << "}\n";
+    }
+
+    /*!
+     * \brief Write the statistics of all regions and counters to a JSON file.
+     *
+     * \copydetails writeJson(std::ostream&)
+     */
+    static void writeJson(const std::string& fileName)
+    {
+        std::ofstream os;
+        if (rank_() == 0)
+            os.open(fileName);
+        // all processes must throw, else the others would wait for rank 0 forever
+        if (!allSucceeded_(rank_() != 0 || os.good()))
+            throw std::runtime_error("Could not open profiling output file '"+fileName+"'");
+        writeJson(os);
+    }
+
+    /*!
+     * \brief Write the recorded invocations of the regions in the trace event format.
+     *
+     * The process identifier of the events is the MPI rank and the thread identifier is
+     * the index of the thread in the order in which they first opened a region. This is
+     * a collective operation, only the process of rank 0 writes to the stream.
+     */
+    static void writeChromeTrace(std::ostream& os)
+    {
+        int myRank = rank_();
+        std::ostringstream oss;
+        oss.precision(15);
+        {
+            auto& storage = storage_();
+            std::lock_guard<std::mutex> lock(storage.mutex);
+            for (const auto& threadData : storage.threadData) {
+                for (const auto& event : threadData->traceEvents) {
+                    oss << ",\n{\"name\": \"" << jsonEscape_(event.name) << "\", "
+                        << "\"ph\": \"X\", "
+                        << "\"pid\": " << myRank << ", "
+                        << "\"tid\": " << threadData->threadIdx << ", "
+                        << "\"ts\": " << event.begin << ", "
+                        << "\"dur\": " << event.duration << "}";
+                }
+            }
+        }
+
+        std::vector<std::string> rankEvents = gatherOnRankZero_(oss.str());
+        if (rankEvents.empty())
+            return;
+
+        os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+           << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"rank 0\"}}";
+        for (unsigned rankIdx = 0; rankIdx < rankEvents.size(); ++rankIdx) {
+            if (rankIdx > 0)
+                os << ",\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rankIdx
+                   << ", \"args\": {\"name\": \"rank " << rankIdx << "\"}}";
+            os << rankEvents[rankIdx];
+        }
+        os << "\n]}\n";
+    }
+
+    /*!
+     * \brief Write the recorded invocations of the regions to a file.
+     *
+     * \copydetails writeChromeTrace(std::ostream&)
+     */
+    static void writeChromeTrace(const std::string& fileName)
+    {
+        std::ofstream os;
+        if (rank_() == 0)
+            os.open(fileName);
+        // all processes must throw, else the others would wait for rank 0 forever
+        if (!allSucceeded_(rank_() != 0 || os.good()))
+            throw std::runtime_error("Could not open trace output file '"+fileName+"'");
+        writeChromeTrace(os);
+    }
+
+private:
+    friend class ProfilerRegion;
+
+    // open a region. inherited regions are the ones of the parent path which are
+    // opened by a worker thread: they neither record their time nor trace events
+    // because this is done by the thread which opened them originally.
+    static void beginRegion_(const char *name, bool traced, bool inherited)
+    {
+        ThreadData_& data = threadData_();
+        data.curNodeIdx = childNode_(data, name);
+        data.traced.push_back(traced && !inherited && storage_().traceEvents);
+        data.inherited.push_back(inherited);
+        data.startTimes.push_back(Clock::now());
+    }
+
+    static void endRegion_()
+    {
+        ThreadData_& data = threadData_();
+        if (data.startTimes.empty())
+            // the recorded data was reset while the region was open
+            return;
+
+        Clock::time_point endTime = Clock::now();
+        Clock::time_point startTime = data.startTimes.back();
+        double dt = std::chrono::duration<double>(endTime - startTime).count();
+
+        Node_& node = data.nodes[data.curNodeIdx];
+        if (!data.inherited.back()) {
+            node.time += dt;
+            ++ node.numCalls;
+        }
+
+        if (data.traced.back()) {
+            double begin =
+                std::chrono::duration<double, std::micro>(startTime - storage_().epoch).count();
+            data.traceEvents.push_back(TraceEvent_{node.name, begin, dt*1e6});
+        }
+
+        data.curNodeIdx = node.parentIdx;
+        data.startTimes.pop_back();
+        data.traced.pop_back();
+        data.inherited.pop_back();
+    }
+
+    static Storage_& storage_()
+    {
+        static Storage_ storage;
+        return storage;
+    }
+
+    static ThreadData_& threadData_()
+    {
+        // the data of a thread is owned by the storage object, so it outlives the
+        // thread itself
+        thread_local ThreadData_ *data = nullptr;
+        if (!data) {
+            auto& storage = storage_();
+            std::lock_guard<std::mutex> lock(storage.mutex);
+            storage.threadData.emplace_back(new ThreadData_);
+            data = storage.threadData.back().get();
+            data->threadIdx = static_cast<unsigned>(storage.threadData.size() - 1);
+            data->reset();
+        }
+        return *data;
+    }
+
+    // returns the index of the child of the current node with a given name. the child
+    // is created if it does not exist yet.
+    static unsigned childNode_(ThreadData_& data, const char *name)
+    {
+        for (unsigned childIdx : data.nodes[data.curNodeIdx].childIdx) {
+            const char *childName = data.nodes[childIdx].name;
+            if (childName == name || std::strcmp(childName, name) == 0)
+                return childIdx;
+        }
+
+        unsigned newIdx = static_cast<unsigned>(data.nodes.size());
+        data.nodes.push_back(Node_{name, data.curNodeIdx, /*time=*/0.0, /*numCalls=*/0, {}});
+        data.nodes[data.curNodeIdx].childIdx.push_back(newIdx);
+        return newIdx;
+    }
+
+    static void writeRecords_(std::ostream& os,
+                              const ThreadData_& data,
+                              unsigned nodeIdx,
+                              const std::string& path)
+    {
+        for (unsigned childIdx : data.nodes[nodeIdx].childIdx) {
+            const Node_& child = data.nodes[childIdx];
+            std::string childPath = path.empty() ? child.name : path + "/" + child.name;
+            // regions which were only inherited by the thread are not reported for it
+            if (child.numCalls > 0)
+                os << childPath << "\t" << child.time << " " << child.numCalls << "\n";
+            writeRecords_(os, data, childIdx, childPath);
+        }
+    }
+
+    // write the minimum, maximum and mean of some values. the imbalance is the ratio of
+    // the maximum to the mean. if numEntities is larger than the number of values, the
+    // missing ones are considered to be zero.
+    static void writeStats_(std::ostream& os, const std::vector<double>& values, size_t numEntities = 0)
+    {
+        numEntities = std::max(numEntities, values.size());
+        double minVal = (values.size() < numEntities) ? 0.0 : *std::min_element(values.begin(), values.end());
+        double maxVal = *std::max_element(values.begin(), values.end());
+        double mean = sum_(values)/static_cast<double>(numEntities);
+        os << "{\"num\": " << values.size() << ", "
+           << "\"min\": " << minVal << ", "
+           << "\"max\": " << maxVal << ", "
+           << "\"mean\": " << mean << ", "
+           << "\"imbalance\": " << ((mean > 0.0) ? maxVal/mean : 1.0) << "}";
+    }
+
+    static double sum_(const std::vector<double>& values)
+    {
+        double result = 0.0;
+        for (double v : values)
+            result += v;
+        return result;
+    }
+
+    static std::string jsonEscape_(const std::string& s)
+    {
+        std::string result;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result;
+    }
+
+    static int rank_()
+    {
+        int myRank = 0;
+#if HAVE_MPI
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (initialized)
+            MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+#endif // HAVE_MPI
+        return myRank;
+    }
+
+    // returns true on all processes if the argument is true on all of them
+    static bool allSucceeded_(bool localSuccess)
+    {
+#if HAVE_MPI
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (initialized) {
+            int local = localSuccess ? 1 : 0;
+            int global = 0;
+            MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+            return global != 0;
+        }
+#endif // HAVE_MPI
+        return localSuccess;
+    }
+
+    // send a string from each process to the process of rank 0. the result is empty on
+    // all other processes.
+    static std::vector<std::string> gatherOnRankZero_(const std::string& localData)
+    {
+#if HAVE_MPI
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        int numRanks = 1;
+        if (initialized)
+            MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+
+        if (numRanks > 1) {
+            int myRank = rank_();
+            int localSize = static_cast<int>(localData.size());
+            std::vector<int> sizes(static_cast<size_t>(numRanks));
+            MPI_Gather(&localSize, 1, MPI_INT, sizes.data(), 1, MPI_INT, /*root=*/0, MPI_COMM_WORLD);
+
+            std::vector<int> offsets(static_cast<size_t>(numRanks), 0);
+            for (size_t i = 1; i < offsets.size(); ++i)
+                offsets[i] = offsets[i - 1] + sizes[i - 1];
+
+            std::vector<char> buffer;
+            if (myRank == 0)
+                buffer.resize(static_cast<size_t>(offsets.back() + sizes.back()));
+            MPI_Gatherv(localData.data(), localSize, MPI_CHAR,
+                        buffer.data(), sizes.data(), offsets.data(), MPI_CHAR,
+                        /*root=*/0, MPI_COMM_WORLD);
+
+            std::vector<std::string> result;
+            if (myRank == 0)
+                for (size_t i = 0; i < sizes.size(); ++i)
+                    result.emplace_back(buffer.data() + offsets[i], static_cast<size_t>(sizes[i]));
+            return result;
+        }
+#endif // HAVE_MPI
+
+        return {localData};
+    }
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Opens a profiler region on construction and closes it on destruction.
+ *
+ * \code
+ * {
+ *     ProfilerRegion region("linearize");
+ *     ...
+ * }
+ * \endcode
+ */
+class ProfilerRegion
+{
+public:
+    explicit ProfilerRegion(const char *name, bool traced = true)
+        : numOpen_(0)
+    {
+        if (Profiler::enabled()) {
+            Profiler::beginRegion(name, traced);
+            numOpen_ = 1;
+        }
+    }
+
+    /*!
+     * \brief Open a region within a parallel block.
+     *
+     * If no region is open on the calling thread, the regions of the parent path are
+     * opened first. Their time is not recorded by the calling thread because they
+     * are already accounted for by the thread which spawned the parallel block. The
+     * parent path is usually obtained using Profiler::currentPath() by the thread
+     * which spawns the parallel block.
+     */
+    ProfilerRegion(const char *name, const Profiler::RegionPath& parentPath)
+        : numOpen_(0)
+    {
+        if (!Profiler::enabled())
+            return;
+
+        if (Profiler::threadData_().startTimes.empty()) {
+            for (const char *parentName : parentPath) {
+                Profiler::beginRegion_(parentName, /*traced=*/false, /*inherited=*/true);
+                ++ numOpen_;
+            }
+        }
+
+        Profiler::beginRegion(name);
+        ++ numOpen_;
+    }
+
+    ProfilerRegion(const ProfilerRegion&) = delete;
+    ProfilerRegion& operator=(const ProfilerRegion&) = delete;
+
+    ~ProfilerRegion()
+    {
+        for (; numOpen_ > 0; -- numOpen_)
+            Profiler::endRegion_();
+    }
+
+private:
+    unsigned numOpen_;
+};
+
+} // namespace Opm
+
+#endif
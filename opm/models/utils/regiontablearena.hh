@@ -0,0 +1,394 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::RegionTableArena
+ */
+#ifndef EWOMS_REGION_TABLE_ARENA_HH
+#define EWOMS_REGION_TABLE_ARENA_HH
+
+#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Unused.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A read-only view of a tabulated function which is stored within a
+ *        RegionTableArena.
+ *
+ * The sampling points are either stored using the Scalar type or using single
+ * precision. Evaluating the function yields the same result as
+ * Tabulated1DFunction::eval() for the stored sampling points.
+ */
+template <class Scalar>
+class CompactTabulated1DFunction
+{
+public:
+    CompactTabulated1DFunction()
+        : xScalar_(nullptr)
+        , yScalar_(nullptr)
+        , xFloat_(nullptr)
+        , yFloat_(nullptr)
+        , numSamples_(0)
+    {}
+
+    /*!
+     * \brief Use sampling points which are stored using the Scalar type.
+     */
+    void setScalarData(const Scalar* x, const Scalar* y, size_t numSamples)
+    {
+        xScalar_ = x;
+        yScalar_ = y;
+        xFloat_ = nullptr;
+        yFloat_ = nullptr;
+        numSamples_ = numSamples;
+    }
+
+    /*!
+     * \brief Use sampling points which are stored using single precision.
+     */
+    void setFloatData(const float* x, const float* y, size_t numSamples)
+    {
+        xScalar_ = nullptr;
+        yScalar_ = nullptr;
+        xFloat_ = x;
+        yFloat_ = y;
+        numSamples_ = numSamples;
+    }
+
+    /*!
+     * \brief Returns true if the sampling points are stored using single precision.
+     */
+    bool storesFloat() const
+    { return xFloat_ != nullptr; }
+
+    /*!
+     * \brief Returns the number of sampling points.
+     */
+    size_t numSamples() const
+    { return numSamples_; }
+
+    /*!
+     * \brief Returns the lowest x value of the sampling points.
+     */
+    Scalar xMin() const
+    { return xAt(0); }
+
+    /*!
+     * \brief Returns the highest x value of the sampling points.
+     */
+    Scalar xMax() const
+    { return xAt(numSamples_ - 1); }
+
+    /*!
+     * \brief Returns the x value of a sampling point.
+     */
+    Scalar xAt(size_t sampleIdx) const
+    { return xScalar_ ? xScalar_[sampleIdx] : static_cast<Scalar>(xFloat_[sampleIdx]); }
+
+    /*!
+     * \brief Returns the function value of a sampling point.
+     */
+    Scalar valueAt(size_t sampleIdx) const
+    { return yScalar_ ? yScalar_[sampleIdx] : static_cast<Scalar>(yFloat_[sampleIdx]); }
+
+    /*!
+     * \brief Evaluate the function for a given argument.
+     *
+     * \param x The argument of the function
+     * \param extrapolate If this is true, the function is linearly extrapolated beyond
+     *                    its sampling points. If it is false, the argument must be
+     *                    within the range of the sampling points.
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, bool extrapolate = false) const
+    {
+        size_t segIdx = findSegmentIndex_(scalarValue(x), extrapolate);
+
+        Scalar x0 = xAt(segIdx);
+        Scalar x1 = xAt(segIdx + 1);
+
+        Scalar y0 = valueAt(segIdx);
+        Scalar y1 = valueAt(segIdx + 1);
+
+        Scalar m = (y1 - y0)/(x1 - x0);
+
+        return y0 + (x - x0)*m;
+    }
+
+private:
+    size_t findSegmentIndex_(Scalar x, bool extrapolate OPM_OPTIM_UNUSED) const
+    {
+        assert(numSamples_ > 1);
+
+        // the comparisons are written such that NaNs end up in the first segment
+        if (!(x > xMin())) {
+            assert(extrapolate || x == xMin());
+            return 0;
+        }
+        if (!(x < xMax())) {
+            assert(extrapolate || x == xMax());
+            return numSamples_ - 2;
+        }
+
+        size_t lowIdx = 0;
+        size_t highIdx = numSamples_ - 1;
+        while (lowIdx + 1 < highIdx) {
+            size_t curIdx = (lowIdx + highIdx)/2;
+            if (xAt(curIdx) < x)
+                lowIdx = curIdx;
+            else
+                highIdx = curIdx;
+        }
+
+        return lowIdx;
+    }
+
+    const Scalar* xScalar_;
+    const Scalar* yScalar_;
+    const float* xFloat_;
+    const float* yFloat_;
+    size_t numSamples_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Packs groups of region-indexed tabulated functions into contiguous memory.
+ *
+ * The tables of the regions are usually stored by std::vectors of
+ * Tabulated1DFunction objects, i.e., each table allocates its own sampling points
+ * somewhere on the heap of the thread which read the input. This class copies the
+ * sampling points of all tables into two contiguous buffers, one for the tables
+ * which are stored using the Scalar type and one for the tables which are stored
+ * using single precision. A table is only stored using single precision if this was
+ * requested and if rounding does not change any of its sampling points by more
+ * than the specified relative tolerance and retains the order of the x values.
+ *
+ * Optionally, the packed tables can be replicated: Each replica is packed by the
+ * first thread which accesses it, so if each NUMA domain uses its own replica, the
+ * operating system places its memory on the domain which reads it. The packed
+ * tables are created lazily and need to be invalidated if any of the source tables
+ * is modified.
+ */
+template <class Scalar>
+class RegionTableArena
+{
+public:
+    using SourceTable = Tabulated1DFunction<Scalar>;
+    using Table = CompactTabulated1DFunction<Scalar>;
+
+    /*!
+     * \brief Create an arena for groups of tables.
+     *
+     * \param sources The vectors of the per-region tables of each group. The vectors
+     *                must outlive the arena.
+     */
+    explicit RegionTableArena(const std::vector<const std::vector<SourceTable>*>& sources)
+        : sources_(sources)
+        , useFloat_(false)
+        , floatTolerance_(0.0)
+    { setStorage(/*useFloat=*/false, /*floatTolerance=*/0.0, /*numReplicas=*/1); }
+
+    /*!
+     * \brief Specify how the tables are stored.
+     *
+     * \param useFloat Store the tables using single precision where this is accurate enough
+     * \param floatTolerance The maximum relative error of a sampling point which is
+     *                       stored using single precision
+     * \param numReplicas The number of copies of the packed tables
+     */
+    void setStorage(bool useFloat, Scalar floatTolerance, unsigned numReplicas)
+    {
+        useFloat_ = useFloat;
+        floatTolerance_ = floatTolerance;
+
+        replicas_.clear();
+        for (unsigned replicaIdx = 0; replicaIdx < std::max(numReplicas, 1u); ++replicaIdx)
+            replicas_.emplace_back(new Replica);
+    }
+
+    /*!
+     * \brief Discard the packed tables.
+     *
+     * This must be called after a source table has been modified, but it must not be
+     * called while other threads access the arena.
+     */
+    void invalidate()
+    {
+        for (auto& replica : replicas_)
+            replica->valid.store(false, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns the number of copies of the packed tables.
+     */
+    unsigned numReplicas() const
+    { return static_cast<unsigned>(replicas_.size()); }
+
+    /*!
+     * \brief Returns the packed table of a region.
+     *
+     * \param groupIdx The index of the group of tables in the vector of sources
+     * \param regionIdx The index of the region within the group
+     * \param replicaIdx The index of the copy to be used. Indices beyond the number of
+     *                   replicas use the last copy.
+     */
+    const Table& table(unsigned groupIdx, unsigned regionIdx, unsigned replicaIdx)
+    {
+        Replica& replica = *replicas_[std::min<size_t>(replicaIdx, replicas_.size() - 1)];
+        if (!replica.valid.load(std::memory_order_acquire))
+            pack_(replica);
+
+        assert(regionIdx < sources_[groupIdx]->size());
+        return replica.tables[replica.groupOffsets[groupIdx] + regionIdx];
+    }
+
+private:
+    struct Replica
+    {
+        Replica()
+            : valid(false)
+        {}
+
+        std::vector<Scalar> scalarData;
+        std::vector<float> floatData;
+        std::vector<Table> tables;
+        std::vector<size_t> groupOffsets;
+
+        std::atomic<bool> valid;
+        std::mutex mutex;
+    };
+
+    void pack_(Replica& replica)
+    {
+        std::lock_guard<std::mutex> lock(replica.mutex);
+        if (replica.valid.load(std::memory_order_relaxed))
+            return; // another thread was faster
+
+        // decide how each table is stored and determine the sizes of the buffers
+        std::vector<bool> tableUsesFloat;
+        size_t scalarSize = 0;
+        size_t floatSize = 0;
+        replica.groupOffsets.clear();
+        for (const auto* groupTables : sources_) {
+            replica.groupOffsets.push_back(tableUsesFloat.size());
+            for (const auto& sourceTable : *groupTables) {
+                bool useFloat = useFloat_ && isFloatAccurate_(sourceTable);
+                tableUsesFloat.push_back(useFloat);
+                if (useFloat)
+                    floatSize += 2*sourceTable.numSamples();
+                else
+                    scalarSize += 2*sourceTable.numSamples();
+            }
+        }
+
+        // release the memory of a previous packing: the buffers must be allocated and
+        // initialized by the current thread
+        std::vector<Scalar>().swap(replica.scalarData);
+        std::vector<float>().swap(replica.floatData);
+        replica.scalarData.resize(scalarSize);
+        replica.floatData.resize(floatSize);
+        replica.tables.assign(tableUsesFloat.size(), Table());
+
+        size_t tableIdx = 0;
+        size_t scalarOffset = 0;
+        size_t floatOffset = 0;
+        for (const auto* groupTables : sources_) {
+            for (const auto& sourceTable : *groupTables) {
+                size_t numSamples = sourceTable.numSamples();
+                if (tableUsesFloat[tableIdx]) {
+                    float* x = replica.floatData.data() + floatOffset;
+                    float* y = x + numSamples;
+                    for (size_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+                        x[sampleIdx] = static_cast<float>(sourceTable.xAt(sampleIdx));
+                        y[sampleIdx] = static_cast<float>(sourceTable.valueAt(sampleIdx));
+                    }
+                    replica.tables[tableIdx].setFloatData(x, y, numSamples);
+                    floatOffset += 2*numSamples;
+                }
+                else {
+                    Scalar* x = replica.scalarData.data() + scalarOffset;
+                    Scalar* y = x + numSamples;
+                    for (size_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+                        x[sampleIdx] = sourceTable.xAt(sampleIdx);
+                        y[sampleIdx] = sourceTable.valueAt(sampleIdx);
+                    }
+                    replica.tables[tableIdx].setScalarData(x, y, numSamples);
+                    scalarOffset += 2*numSamples;
+                }
+                ++tableIdx;
+            }
+        }
+
+        replica.valid.store(true, std::memory_order_release);
+    }
+
+    bool isFloatAccurate_(const SourceTable& sourceTable) const
+    {
+        float lastX = 0.0;
+        for (size_t sampleIdx = 0; sampleIdx < sourceTable.numSamples(); ++sampleIdx) {
+            Scalar x = sourceTable.xAt(sampleIdx);
+            if (!isFloatAccurate_(x) || !isFloatAccurate_(sourceTable.valueAt(sampleIdx)))
+                return false;
+
+            // rounding must not merge sampling points
+            float roundedX = static_cast<float>(x);
+            if (sampleIdx > 0 && !(roundedX > lastX))
+                return false;
+            lastX = roundedX;
+        }
+
+        return true;
+    }
+
+    bool isFloatAccurate_(Scalar value) const
+    {
+        Scalar roundedValue = static_cast<Scalar>(static_cast<float>(value));
+        if (!std::isfinite(roundedValue))
+            return false;
+        return std::abs(roundedValue - value) <= floatTolerance_*std::abs(value);
+    }
+
+    std::vector<const std::vector<SourceTable>*> sources_;
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    bool useFloat_;
+    Scalar floatTolerance_;
+};
+
+} // namespace Opm
+
+#endif
@@ -34,7 +34,9 @@
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/models/parallel/mpiutil.hh>
+#include <opm/models/parallel/tasklets.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 
 #include <dune/common/version.hh>
@@ -46,6 +48,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <exception>
 
 #define EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(code)                      \
     {                                                                   \
@@ -95,6 +98,36 @@ class Simulator
     using Model = GetPropType<TypeTag, Properties::Model>;
     using Problem = GetPropType<TypeTag, Properties::Problem>;
 
+    // writes a restart file which was previously staged in memory to disk. since the
+    // tasklet runner does not propagate exceptions, a failure is kept until the
+    // simulator waits for the tasklet.
+    class WriteRestartTasklet : public TaskletInterface
+    {
+    public:
+        WriteRestartTasklet(std::shared_ptr<Restart> restart)
+            : restart_(restart)
+        { }
+
+        void run() final
+        {
+            try {
+                restart_->writeStaged();
+            }
+            catch (...) {
+                exception_ = std::current_exception();
+            }
+        }
+
+        // the exception thrown while writing the file. this must only be called after
+        // the tasklet has been run, i.e., after a barrier.
+        std::exception_ptr exception() const
+        { return exception_; }
+
+    private:
+        std::shared_ptr<Restart> restart_;
+        std::exception_ptr exception_;
+    };
+
 public:
     // do not allow to copy simulators around
     Simulator(const Simulator& ) = delete;
@@ -131,6 +164,12 @@ public:
 
         finished_ = false;
 
+        restartWriteInterval_ = EWOMS_GET_PARAM(TypeTag, int, RestartWriteInterval);
+        restartWriteWallTimeInterval_ = EWOMS_GET_PARAM(TypeTag, Scalar, RestartWriteWallTimeInterval);
+        lastRestartWallTime_ = 0.0;
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncRestart))
+            restartTaskletRunner_.reset(new TaskletRunner(/*numWorkers=*/1));
+
         if (verbose_)
             std::cout << "Allocating the simulation vanguard\n" << std::flush;
 
@@ -242,6 +281,18 @@ public:
                              "The size of the initial time step [s]");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, RestartTime,
                              "The simulation time at which a restart should be attempted [s]");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableBinaryRestart,
+                             "Write restart files in the binary format which stores the raw "
+                             "primary variables and a checksum for each section");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncRestart,
+                             "Stage the data of restart files in memory and write it to disk "
+                             "in a separate thread");
+        EWOMS_REGISTER_PARAM(TypeTag, int, RestartWriteInterval,
+                             "Write a restart file every N time steps in addition to the ones "
+                             "requested by the problem (0 to disable)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, RestartWriteWallTimeInterval,
+                             "Write a restart file if the given wall clock time has passed since "
+                             "the last one [s] (0 to disable)");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, PredeterminedTimeStepsFile,
                              "A file with a list of predetermined time step sizes (one "
                              "time step per line)");
@@ -717,6 +768,7 @@ public:
 
             try {
                 // execute the time integration scheme
+                ProfilerRegion region("time integration");
                 problem_->timeIntegration();
             }
             catch (...) {
@@ -744,8 +796,10 @@ public:
 
             // write the result to disk
             writeTimer_.start();
-            if (problem_->shouldWriteOutput())
+            if (problem_->shouldWriteOutput()) {
+                ProfilerRegion region("output");
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->writeOutput());
+            }
             writeTimer_.stop();
 
             // do the next time integration
@@ -786,12 +840,15 @@ public:
 
             // write restart file if mandated by the problem
             writeTimer_.start();
-            if (problem_->shouldWriteRestartFile())
+            if (problem_->shouldWriteRestartFile() || restartIntervalIsOver_())
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(serialize());
             writeTimer_.stop();
         }
         executionTimer_.stop();
 
+        // make sure that all restart files have been written
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(waitForRestartWrite_());
+
         EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->finalize());
     }
 
@@ -884,21 +941,38 @@ public:
      * method, has the current time of the simulation clock in it's
      * name and uses the extension <tt>.ers</tt>. (Ewoms ReStart
      * file.)  See Opm::Restart for details.
+     *
+     * If asynchronous restart files are enabled, the state is only
+     * serialized into memory by this method and the data is written to
+     * disk by a separate thread while the simulation continues. If
+     * writing the previous restart file failed, an exception is thrown.
      */
     void serialize()
     {
+        // limit the memory used for staging to a single restart file
+        waitForRestartWrite_();
+
         using Restarter = Restart;
-        Restarter res;
-        res.serializeBegin(*this);
+        bool async = static_cast<bool>(restartTaskletRunner_);
+        auto res = std::make_shared<Restarter>(EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart),
+                                               /*staged=*/async);
+        res->serializeBegin(*this);
         if (gridView().comm().rank() == 0)
-            std::cout << "Serialize to file '" << res.fileName() << "'"
+            std::cout << "Serialize to file '" << res->fileName() << "'"
                       << ", next time step size: " << timeStepSize()
                       << "\n" << std::flush;
 
-        this->serialize(res);
-        problem_->serialize(res);
-        model_->serialize(res);
-        res.serializeEnd();
+        this->serialize(*res);
+        problem_->serialize(*res);
+        model_->serialize(*res);
+        res->serializeEnd();
+
+        if (async) {
+            restartTasklet_ = std::make_shared<WriteRestartTasklet>(res);
+            restartTaskletRunner_->dispatch(restartTasklet_);
+        }
+
+        lastRestartWallTime_ = executionTimer_.realTimeElapsed();
     }
 
     /*!
@@ -944,6 +1018,39 @@ public:
     }
 
 private:
+    // returns true if a restart file is due because of the time step or wall clock
+    // time intervals
+    bool restartIntervalIsOver_() const
+    {
+        if (restartWriteInterval_ > 0 && timeStepIdx_ % restartWriteInterval_ == 0)
+            return true;
+
+        if (restartWriteWallTimeInterval_ > 0) {
+            // the wall clock time differs between processes, but all of them must
+            // agree whether a restart file is written
+            Scalar elapsed = executionTimer_.realTimeElapsed() - lastRestartWallTime_;
+            return gridView().comm().max(elapsed) >= restartWriteWallTimeInterval_;
+        }
+
+        return false;
+    }
+
+    // wait until the restart file which is written asynchronously is on disk and
+    // throw if writing it failed
+    void waitForRestartWrite_()
+    {
+        if (!restartTaskletRunner_)
+            return;
+
+        restartTaskletRunner_->barrier();
+        if (restartTasklet_) {
+            std::exception_ptr exceptionPtr = restartTasklet_->exception();
+            restartTasklet_.reset();
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
+        }
+    }
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -970,6 +1077,12 @@ private:
 
     bool finished_;
     bool verbose_;
+
+    int restartWriteInterval_;
+    Scalar restartWriteWallTimeInterval_;
+    Scalar lastRestartWallTime_;
+    std::unique_ptr<TaskletRunner> restartTaskletRunner_;
+    std::shared_ptr<WriteRestartTasklet> restartTasklet_;
 };
 
 namespace Properties {
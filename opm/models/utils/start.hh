@@ -36,6 +36,7 @@
 
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/timer.hh>
+#include <opm/models/utils/profiler.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -87,6 +88,20 @@ static inline void registerAllParameters_(bool finalizeRegistration = true)
     EWOMS_REGISTER_PARAM(TypeTag, int, PrintParameters,
                          "Print the values of the run-time parameters at the "
                          "start of the simulation");
+    EWOMS_REGISTER_PARAM(TypeTag, bool, PrintParameterReads,
+                         "Print how often each run-time parameter was retrieved "
+                         "at the end of the simulation");
+    EWOMS_REGISTER_PARAM(TypeTag, bool, PrintMemoryFootprint,
+                         "Print the number of bytes which the model requires per "
+                         "degree of freedom");
+    EWOMS_REGISTER_PARAM(TypeTag, bool, EnableProfiling,
+                         "Record the time spent in the instrumented regions of the "
+                         "simulator");
+    EWOMS_REGISTER_PARAM(TypeTag, std::string, ProfilingOutputFile,
+                         "The JSON file to which the profiling statistics are written");
+    EWOMS_REGISTER_PARAM(TypeTag, std::string, ProfilingTraceFile,
+                         "The file to which the profiled regions are written in the "
+                         "Chrome trace event format. Empty means that no trace is recorded");
 
     Simulator::registerParameters();
     ThreadManager::registerParameters();
@@ -206,6 +221,68 @@ static inline int setupParameters_(int argc,
     return /*status=*/0;
 }
 
+/*!
+ * \brief Set up everything which is required before a simulator can be instantiated.
+ *
+ * This parses the run-time parameters, initializes the thread manager and MPI and
+ * checks that the mandatory parameters of the time discretization are specified. The
+ * parameters must already have been registered.
+ *
+ * \param argc The number of command line arguments
+ * \param argv The array of the command line arguments
+ * \param requireEndTime Specifies whether the '--end-time' parameter is mandatory
+ * \param myRank Set to the MPI rank of the current process
+ * \return 1 for errors, 2 if the program should exit without an error or 0 if the
+ *         simulator can be instantiated.
+ */
+template <class TypeTag>
+static inline int setupSimulatorEnvironment_(int argc,
+                                             char **argv,
+                                             bool requireEndTime,
+                                             int& myRank)
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+
+    int paramStatus = setupParameters_<TypeTag>(argc,
+                                                const_cast<const char**>(argv),
+                                                /*registerParams=*/false);
+    if (paramStatus == 1 || paramStatus == 2)
+        return paramStatus;
+
+    ThreadManager::init();
+
+    // initialize MPI, finalize is done automatically on exit
+#if HAVE_DUNE_FEM
+    Dune::Fem::MPIManager::initialize(argc, argv);
+    myRank = Dune::Fem::MPIManager::rank();
+#else
+    myRank = Dune::MPIHelper::instance(argc, argv).rank();
+#endif
+
+    // read the initial time step and the end time
+    if (requireEndTime) {
+        Scalar endTime = EWOMS_GET_PARAM(TypeTag, Scalar, EndTime);
+        if (endTime < -1e50) {
+            if (myRank == 0)
+                Parameters::printUsage<TypeTag>(argv[0],
+                                                "Mandatory parameter '--end-time' not specified!");
+            return 1;
+        }
+    }
+
+    Scalar initialTimeStepSize = EWOMS_GET_PARAM(TypeTag, Scalar, InitialTimeStepSize);
+    if (initialTimeStepSize < -1e50) {
+        if (myRank == 0)
+            Parameters::printUsage<TypeTag>(argv[0],
+                                            "Mandatory parameter '--initial-time-step-size' "
+                                            "not specified!");
+        return 1;
+    }
+
+    return 0;
+}
+
 /*!
  * \brief Resets the current TTY to a usable state if the program was aborted.
  *
@@ -279,10 +356,8 @@ static inline void resetTerminal_(int signum)
 template <class TypeTag>
 static inline int start(int argc, char **argv,  bool registerParams=true)
 {
-    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Problem = GetPropType<TypeTag, Properties::Problem>;
-    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     // set the signal handlers to reset the TTY to a well defined state on unexpected
     // program aborts
@@ -301,39 +376,16 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
     int myRank = 0;
     try
     {
-        int paramStatus = setupParameters_<TypeTag>(argc, const_cast<const char**>(argv), registerParams);
-        if (paramStatus == 1)
-            return 1;
-        if (paramStatus == 2)
-            return 0;
-
-        ThreadManager::init();
-
-        // initialize MPI, finalize is done automatically on exit
-#if HAVE_DUNE_FEM
-        Dune::Fem::MPIManager::initialize(argc, argv);
-        myRank = Dune::Fem::MPIManager::rank();
-#else
-        myRank = Dune::MPIHelper::instance(argc, argv).rank();
-#endif
-
-        // read the initial time step and the end time
-        Scalar endTime = EWOMS_GET_PARAM(TypeTag, Scalar, EndTime);
-        if (endTime < -1e50) {
-            if (myRank == 0)
-                Parameters::printUsage<TypeTag>(argv[0],
-                                                "Mandatory parameter '--end-time' not specified!");
-            return 1;
-        }
+        if (registerParams)
+            registerAllParameters_<TypeTag>();
 
-        Scalar initialTimeStepSize = EWOMS_GET_PARAM(TypeTag, Scalar, InitialTimeStepSize);
-        if (initialTimeStepSize < -1e50) {
-            if (myRank == 0)
-                Parameters::printUsage<TypeTag>(argv[0],
-                                                "Mandatory parameter '--initial-time-step-size' "
-                                                "not specified!");
+        int setupStatus = setupSimulatorEnvironment_<TypeTag>(argc, argv,
+                                                              /*requireEndTime=*/true,
+                                                              myRank);
+        if (setupStatus == 1)
             return 1;
-        }
+        if (setupStatus == 2)
+            return 0;
 
         if (myRank == 0) {
 #ifdef EWOMS_VERSION
@@ -386,12 +438,32 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
                 Properties::printValues<TypeTag>();
         }
 
+        bool printParamReads = EWOMS_GET_PARAM(TypeTag, bool, PrintParameterReads);
+        Parameters::setCountReads<TypeTag>(printParamReads);
+
+        bool enableProfiling = EWOMS_GET_PARAM(TypeTag, bool, EnableProfiling);
+        const std::string traceFile = EWOMS_GET_PARAM(TypeTag, std::string, ProfilingTraceFile);
+        if (enableProfiling)
+            Profiler::enable(/*traceEvents=*/!traceFile.empty());
+
         // instantiate and run the concrete problem. make sure to
         // deallocate the problem and before the time manager and the
         // grid
         Simulator simulator;
+        if (EWOMS_GET_PARAM(TypeTag, bool, PrintMemoryFootprint) && myRank == 0)
+            simulator.model().printMemoryFootprint(std::cout);
         simulator.run();
 
+        if (printParamReads && myRank == 0)
+            Parameters::printReadCounts<TypeTag>();
+
+        if (enableProfiling) {
+            Profiler::disable();
+            Profiler::writeJson(EWOMS_GET_PARAM(TypeTag, std::string, ProfilingOutputFile));
+            if (!traceFile.empty())
+                Profiler::writeChromeTrace(traceFile);
+        }
+
         if (myRank == 0) {
             std::cout << "eWoms reached the destination. If it is not the one that was intended, "
                       << "change the booking and try again.\n"
@@ -0,0 +1,166 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::TabulatedSegmentHint
+ */
+#ifndef EWOMS_TABULATED_SEGMENT_HINT_HH
+#define EWOMS_TABULATED_SEGMENT_HINT_HH
+
+#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Unused.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Evaluates a tabulated function starting with the segment which was used by
+ *        the previous evaluation.
+ *
+ * Tabulated1DFunction::eval() bisects the sampling points for every lookup. If the
+ * arguments only change slightly between calls, as it is the case for the
+ * properties of a cell during the iterations of the Newton method, the segment of
+ * the previous lookup or one of its neighbors almost always is the right one. If
+ * this is not the case, the segment is guessed under the assumption that the
+ * sampling points are equidistant (which is exact for uniformly sampled tables)
+ * before the bisection is limited to one side of the guess.
+ *
+ * An object of this class is intended to be used for a single table, e.g., by
+ * storing it within the intensive quantities of a degree of freedom. The result of
+ * an evaluation is the same as the one of Tabulated1DFunction::eval(). Besides
+ * Tabulated1DFunction, the tables packed by RegionTableArena can be evaluated.
+ */
+class TabulatedSegmentHint
+{
+public:
+    TabulatedSegmentHint()
+        : segIdx_(0)
+    {}
+
+    /*!
+     * \brief Evaluate a tabulated function for a given argument.
+     *
+     * \param table The tabulated function to be evaluated, i.e., a Tabulated1DFunction
+     *              or a CompactTabulated1DFunction
+     * \param x The argument of the function
+     * \param extrapolate If this is true, the function is linearly extrapolated beyond
+     *                    its sampling points. If it is false, the argument must be
+     *                    within the range of the sampling points.
+     */
+    template <class Table, class Evaluation>
+    Evaluation eval(const Table& table,
+                    const Evaluation& x,
+                    bool extrapolate = false)
+    {
+        using Scalar = typename std::decay<decltype(table.xMin())>::type;
+
+        size_t segIdx = findSegment_(table, static_cast<Scalar>(scalarValue(x)), extrapolate);
+        segIdx_ = static_cast<unsigned>(segIdx);
+
+        Scalar x0 = table.xAt(segIdx);
+        Scalar x1 = table.xAt(segIdx + 1);
+
+        Scalar y0 = table.valueAt(segIdx);
+        Scalar y1 = table.valueAt(segIdx + 1);
+
+        Scalar m = (y1 - y0)/(x1 - x0);
+
+        return y0 + (x - x0)*m;
+    }
+
+    /*!
+     * \brief Returns the index of the segment which was used by the last evaluation.
+     */
+    unsigned segmentIndex() const
+    { return segIdx_; }
+
+private:
+    template <class Table, class Scalar>
+    size_t findSegment_(const Table& table,
+                        Scalar x,
+                        bool extrapolate OPM_OPTIM_UNUSED) const
+    {
+        size_t numSegments = table.numSamples() - 1;
+        assert(numSegments > 0);
+
+        // the comparisons are written such that NaNs end up in the first segment
+        if (!(x > table.xMin())) {
+            assert(extrapolate || x == table.xMin());
+            return 0;
+        }
+        if (!(x < table.xMax())) {
+            assert(extrapolate || x == table.xMax());
+            return numSegments - 1;
+        }
+
+        // the segment of the previous lookup and its neighbors
+        size_t hintIdx = std::min<size_t>(segIdx_, numSegments - 1);
+        if (table.xAt(hintIdx) <= x) {
+            if (x <= table.xAt(hintIdx + 1))
+                return hintIdx;
+            if (hintIdx + 2 <= numSegments && x <= table.xAt(hintIdx + 2))
+                return hintIdx + 1;
+        }
+        else if (hintIdx > 0 && table.xAt(hintIdx - 1) <= x)
+            return hintIdx - 1;
+
+        // the segment if the sampling points were equidistant
+        Scalar relX = (x - table.xMin())/(table.xMax() - table.xMin());
+        size_t guessIdx = std::min<size_t>(static_cast<size_t>(relX*numSegments), numSegments - 1);
+
+        // bisect the part of the table which is on the right side of the guess
+        size_t lowIdx = 0;
+        size_t highIdx = numSegments;
+        if (x < table.xAt(guessIdx))
+            highIdx = guessIdx;
+        else if (x <= table.xAt(guessIdx + 1))
+            return guessIdx;
+        else
+            lowIdx = guessIdx + 1;
+
+        // invariant: xAt(lowIdx) <= x <= xAt(highIdx)
+        while (lowIdx + 1 < highIdx) {
+            size_t curIdx = (lowIdx + highIdx)/2;
+            if (table.xAt(curIdx) < x)
+                lowIdx = curIdx;
+            else
+                highIdx = curIdx;
+        }
+
+        return lowIdx;
+    }
+
+    unsigned segIdx_;
+};
+
+} // namespace Opm
+
+#endif
@@ -30,6 +30,7 @@
 #include "overlaptypes.hh"
 
 #include <opm/models/parallel/mpibuffer.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/material/common/Valgrind.hpp>
 
 #include <dune/istl/bvector.hh>
@@ -174,6 +175,8 @@ public:
      */
     void sync()
     {
+        ProfilerRegion profilerRegion("halo exchange");
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
@@ -192,6 +195,8 @@ public:
      */
     void syncAdd()
     {
+        ProfilerRegion profilerRegion("halo exchange");
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
@@ -27,6 +27,8 @@
 #ifndef EWOMS_OVERLAPPING_OPERATOR_HH
 #define EWOMS_OVERLAPPING_OPERATOR_HH
 
+#include <opm/models/utils/profiler.hh>
+
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
@@ -57,7 +59,10 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
+        {
+            ProfilerRegion profilerRegion("SpMV");
+            A_.mv(x, y);
+        }
         y.sync();
     }
 
@@ -65,7 +70,10 @@ public:
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
+        {
+            ProfilerRegion profilerRegion("SpMV");
+            A_.usmv(alpha, x, y);
+        }
         y.sync();
     }
 
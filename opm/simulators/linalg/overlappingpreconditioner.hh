@@ -29,6 +29,8 @@
 
 #include "overlappingscalarproduct.hh"
 
+#include <opm/models/utils/profiler.hh>
+
 #include <opm/material/common/Exceptions.hpp>
 
 #include <dune/istl/preconditioners.hh>
@@ -100,6 +102,7 @@ public:
 
     void apply(domain_type& x, const range_type& d) override
     {
+        ProfilerRegion profilerRegion("preconditioner apply");
 #if HAVE_MPI
         if (overlap_->peerSet().size() > 0) {
             // make sure that all processes react the same if the
@@ -37,6 +37,7 @@
 #include <opm/simulators/linalg/istlpreconditionerwrappers.hh>
 
 #include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
@@ -136,6 +137,7 @@ public:
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
         , lastIterations_( -1 )
+        , linearSolverTolerance_(EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance))
     {
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
@@ -278,6 +280,7 @@ public:
         auto result = asImp_().runSolver_(solver);
         // store number of iterations used
         lastIterations_ = result.second;
+        Profiler::addToCounter("linear iterations", static_cast<double>(lastIterations_));
 
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
@@ -292,6 +295,25 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Returns the reduction of the residual which is required for the linear
+     *        solver to be considered converged.
+     *
+     * Unless it is changed using setLinearSolverTolerance(), this is the value of the
+     * LinearSolverTolerance parameter.
+     */
+    Scalar linearSolverTolerance() const
+    { return linearSolverTolerance_; }
+
+    /*!
+     * \brief Set the reduction of the residual which is required for the linear solver
+     *        to be considered converged.
+     *
+     * The new value is used starting with the next call to solve().
+     */
+    void setLinearSolverTolerance(Scalar value)
+    { linearSolverTolerance_ = value; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -316,6 +338,7 @@ protected:
         int preconditionerIsReady = 1;
         try {
             // update sequential preconditioner
+            ProfilerRegion profilerRegion("preconditioner setup");
             precWrapper_.prepare(*overlappingMatrix_);
         }
         catch (const Dune::Exception& e) {
@@ -380,6 +403,7 @@ protected:
     const Simulator& simulator_;
     int gridSequenceNumber_;
     size_t lastIterations_;
+    Scalar linearSolverTolerance_;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
@@ -97,6 +97,24 @@ public:
     bool solve(Vector& x)
     { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
 
+    /*!
+     * \brief Returns the reduction of the residual which is required for the linear
+     *        solver to be considered converged.
+     *
+     * Since SuperLU is a direct solver, this is always zero.
+     */
+    Scalar linearSolverTolerance() const
+    { return 0.0; }
+
+    /*!
+     * \brief Set the reduction of the residual which is required for the linear solver
+     *        to be considered converged.
+     *
+     * Since SuperLU is a direct solver, this is a no-op.
+     */
+    void setLinearSolverTolerance(Scalar value OPM_UNUSED)
+    { }
+
 private:
     const Matrix* M_;
     Vector* b_;
@@ -0,0 +1,126 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the line search of the Newton method shortens updates which lead
+ *        to non-physical solutions instead of aborting the time step.
+ *
+ * The lens problem is simulated using a variant which cannot evaluate its residual if
+ * a saturation is outside of the physically meaningful range. Undershooting
+ * saturations at the infiltration front are typical for the full Newton updates of
+ * large time steps.
+ */
+#include "config.h"
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <opm/models/utils/start.hh>
+
+#include <opm/material/common/Exceptions.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+namespace Opm {
+template <class TypeTag>
+class NonphysicalLensProblem : public LensProblem<TypeTag>
+{
+    using ParentType = LensProblem<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using RateVector = GetPropType<TypeTag, Properties::RateVector>;
+
+public:
+    NonphysicalLensProblem(Simulator& simulator)
+        : ParentType(simulator)
+    { }
+
+    std::string name() const
+    { return "lens_linesearch"; }
+
+    /*!
+     * \copydoc FvBaseProblem::source
+     *
+     * The source term is zero, but it cannot be evaluated for solutions which exhibit
+     * non-physical saturations.
+     */
+    template <class Context>
+    void source(RateVector& rate,
+                const Context& context,
+                unsigned spaceIdx,
+                unsigned timeIdx) const
+    {
+        Scalar S = context.primaryVars(spaceIdx, timeIdx)[Indices::saturation0Idx];
+        if (S < -maxSaturationDefect || S > 1.0 + maxSaturationDefect) {
+            ++ numNonphysicalStates;
+            throw NumericalIssue("Non-physical saturation "+std::to_string(S));
+        }
+
+        rate = Scalar(0.0);
+    }
+
+    static constexpr Scalar maxSaturationDefect = 1e-2;
+    static std::atomic<int> numNonphysicalStates;
+};
+
+template <class TypeTag>
+std::atomic<int> NonphysicalLensProblem<TypeTag>::numNonphysicalStates{0};
+} // namespace Opm
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LensProblemEcfvAdLineSearch { using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct Problem<TypeTag, TTag::LensProblemEcfvAdLineSearch>
+{ using type = Opm::NonphysicalLensProblem<TypeTag>; };
+
+template<class TypeTag>
+struct NewtonEnableLineSearch<TypeTag, TTag::LensProblemEcfvAdLineSearch>
+{ static constexpr bool value = true; };
+
+} // namespace Opm::Properties
+
+int main(int argc, char **argv)
+{
+    using ProblemTypeTag = Opm::Properties::TTag::LensProblemEcfvAdLineSearch;
+    using Problem = Opm::GetPropType<ProblemTypeTag, Opm::Properties::Problem>;
+
+    int status = Opm::start<ProblemTypeTag>(argc, argv);
+    if (status != 0)
+        return status;
+
+    // make sure that non-physical trial solutions were actually encountered
+    if (Problem::numNonphysicalStates == 0) {
+        std::cerr << "The Newton method did not encounter any non-physical solution\n";
+        return 1;
+    }
+
+    return 0;
+}
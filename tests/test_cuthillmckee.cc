@@ -0,0 +1,121 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the reverse Cuthill-McKee ordering reduces the bandwidth and
+ *        the memory distance of neighbors for a randomly numbered structured grid.
+ */
+#include "config.h"
+
+#include <opm/models/utils/cuthillmckee.hh>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using AdjacencyList = std::vector<std::vector<unsigned>>;
+
+// the cells of a nx x ny grid with a five point stencil, numbered randomly
+static AdjacencyList createShuffledGrid(unsigned nx, unsigned ny)
+{
+    std::vector<unsigned> cellIdx(nx*ny);
+    std::iota(cellIdx.begin(), cellIdx.end(), 0);
+    std::mt19937 rng(12345);
+    std::shuffle(cellIdx.begin(), cellIdx.end(), rng);
+
+    AdjacencyList adjacency(nx*ny);
+    for (unsigned j = 0; j < ny; ++j) {
+        for (unsigned i = 0; i < nx; ++i) {
+            unsigned idx = cellIdx[j*nx + i];
+            if (i > 0)
+                adjacency[idx].push_back(cellIdx[j*nx + i - 1]);
+            if (i + 1 < nx)
+                adjacency[idx].push_back(cellIdx[j*nx + i + 1]);
+            if (j > 0)
+                adjacency[idx].push_back(cellIdx[(j - 1)*nx + i]);
+            if (j + 1 < ny)
+                adjacency[idx].push_back(cellIdx[(j + 1)*nx + i]);
+        }
+    }
+
+    return adjacency;
+}
+
+// the average distance between the positions of neighboring nodes
+static double meanNeighborDistance(const AdjacencyList& adjacency,
+                                   const std::vector<unsigned>& ordering)
+{
+    std::vector<unsigned> position(ordering.size());
+    for (unsigned k = 0; k < ordering.size(); ++k)
+        position[ordering[k]] = k;
+
+    double sum = 0.0;
+    size_t numEdges = 0;
+    for (unsigned nodeIdx = 0; nodeIdx < adjacency.size(); ++nodeIdx) {
+        for (unsigned neighborIdx : adjacency[nodeIdx]) {
+            sum += std::abs(static_cast<double>(position[nodeIdx]) - position[neighborIdx]);
+            ++numEdges;
+        }
+    }
+
+    return sum/numEdges;
+}
+
+int main()
+{
+    unsigned nx = 300;
+    unsigned ny = 300;
+    const auto adjacency = createShuffledGrid(nx, ny);
+
+    std::vector<unsigned> identity(adjacency.size());
+    std::iota(identity.begin(), identity.end(), 0);
+    const auto rcm = Opm::reverseCuthillMcKee(adjacency);
+
+    // make sure that the result is a permutation
+    std::vector<unsigned> sorted(rcm);
+    std::sort(sorted.begin(), sorted.end());
+    if (sorted != identity) {
+        std::cerr << "The reverse Cuthill-McKee ordering is not a permutation\n";
+        return 1;
+    }
+
+    size_t origBandwidth = Opm::graphBandwidth(adjacency, identity);
+    size_t rcmBandwidth = Opm::graphBandwidth(adjacency, rcm);
+
+    std::cout << "bandwidth: " << origBandwidth << " (original), "
+              << rcmBandwidth << " (reverse Cuthill-McKee)\n"
+              << "mean neighbor distance: " << meanNeighborDistance(adjacency, identity)
+              << " (original), " << meanNeighborDistance(adjacency, rcm)
+              << " (reverse Cuthill-McKee)\n";
+
+    // the bandwidth of the structured grid is at most about two rows of cells
+    if (rcmBandwidth > 2*std::max(nx, ny) + 1) {
+        std::cerr << "The reverse Cuthill-McKee ordering did not reduce the bandwidth\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the local Jacobians of the automatic differentiation linearizer
+ *        do not change if the gradient calculator is only prepared for the first
+ *        focus degree of freedom of an element.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include "problems/lensproblem.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct FocusedExtensiveQuantitiesTestProblem
+{ using InheritsFrom = std::tuple<LensBaseProblem, ImmiscibleTwoPhaseModel>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::FocusedExtensiveQuantitiesTestProblem>
+{ using type = TTag::AutoDiffLocalLinearizer; };
+
+// the storage term of the old time step is evaluated instead of being cached
+template<class TypeTag>
+struct EnableStorageCache<TypeTag, TTag::FocusedExtensiveQuantitiesTestProblem>
+{ static constexpr bool value = false; };
+
+// the P1 gradients are the ones which are expensive to prepare
+#if HAVE_DUNE_LOCALFUNCTIONS
+template<class TypeTag>
+struct UseP1FiniteElementGradients<TypeTag, TTag::FocusedExtensiveQuantitiesTestProblem>
+{ static constexpr bool value = true; };
+#endif
+
+} // namespace Opm::Properties
+
+int main(int argc, char **argv)
+{
+    using TypeTag = Opm::Properties::TTag::FocusedExtensiveQuantitiesTestProblem;
+    using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+    using ElementContext = Opm::GetPropType<TypeTag, Opm::Properties::ElementContext>;
+    using LocalLinearizer = Opm::GetPropType<TypeTag, Opm::Properties::LocalLinearizer>;
+    using LocalResidual = Opm::GetPropType<TypeTag, Opm::Properties::LocalResidual>;
+
+    enum { numEq = Opm::getPropValue<TypeTag, Opm::Properties::NumEq>() };
+
+    Opm::registerAllParameters_<TypeTag>();
+    int myRank = 0;
+    if (Opm::setupSimulatorEnvironment_<TypeTag>(argc, argv,
+                                                 /*requireEndTime=*/false,
+                                                 myRank) != 0)
+        return 1;
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+
+    LocalLinearizer linearizer;
+    linearizer.init(simulator);
+
+    // the reference re-computes all extensive quantities including the gradients for
+    // each focus degree of freedom
+    ElementContext elemCtx(simulator);
+    LocalResidual localResidual;
+
+    double maxJacobian = 0.0;
+    for (const auto& elem : elements(simulator.gridView())) {
+        linearizer.linearize(elem);
+
+        elemCtx.updateStencil(elem);
+        elemCtx.updateAllIntensiveQuantities();
+
+        unsigned numDof = elemCtx.numDof(/*timeIdx=*/0);
+        unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned focusDofIdx = 0; focusDofIdx < numPrimaryDof; ++focusDofIdx) {
+            elemCtx.setFocusDofIndex(focusDofIdx);
+            elemCtx.updateAllExtensiveQuantities();
+            localResidual.eval(elemCtx);
+
+            const auto& resid = localResidual.residual();
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                        double expected = resid[dofIdx][eqIdx].derivative(pvIdx);
+                        double value = linearizer.jacobian(dofIdx, focusDofIdx)[eqIdx][pvIdx];
+                        maxJacobian = std::max(maxJacobian, std::abs(expected));
+                        if (std::abs(value - expected) > 1e-10*std::max(1.0, std::abs(expected))) {
+                            std::cerr << "Wrong derivative of equation " << eqIdx
+                                      << " of DOF " << dofIdx
+                                      << " with regard to primary variable " << pvIdx
+                                      << " of DOF " << focusDofIdx << ": " << value
+                                      << " instead of " << expected << "\n";
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // make sure that the comparison was not trivial
+    if (maxJacobian == 0.0) {
+        std::cerr << "All local Jacobians are zero\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the sweep over the grid which populates the intensive quantity
+ *        cache computes the same intensive quantities as the element contexts.
+ *
+ * The vertex centered finite volume discretization is used so that most degrees of
+ * freedom are shared by several elements which may be handled by different threads.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include "problems/lensproblem.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct IntensiveQuantitiesCacheTestProblem
+{ using InheritsFrom = std::tuple<LensBaseProblem, ImmiscibleTwoPhaseModel>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::IntensiveQuantitiesCacheTestProblem>
+{ using type = TTag::AutoDiffLocalLinearizer; };
+
+template<class TypeTag>
+struct EnableIntensiveQuantityCache<TypeTag, TTag::IntensiveQuantitiesCacheTestProblem>
+{ static constexpr bool value = true; };
+
+} // namespace Opm::Properties
+
+int main(int argc, char **argv)
+{
+    using TypeTag = Opm::Properties::TTag::IntensiveQuantitiesCacheTestProblem;
+    using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+    using ElementContext = Opm::GetPropType<TypeTag, Opm::Properties::ElementContext>;
+    using Evaluation = Opm::GetPropType<TypeTag, Opm::Properties::Evaluation>;
+    using FluidSystem = Opm::GetPropType<TypeTag, Opm::Properties::FluidSystem>;
+
+    enum { numEq = Opm::getPropValue<TypeTag, Opm::Properties::NumEq>() };
+    enum { numPhases = FluidSystem::numPhases };
+
+    Opm::registerAllParameters_<TypeTag>();
+    int myRank = 0;
+    if (Opm::setupSimulatorEnvironment_<TypeTag>(argc, argv,
+                                                 /*requireEndTime=*/false,
+                                                 myRank) != 0)
+        return 1;
+
+    Simulator simulator(/*verbose=*/false);
+    auto& model = simulator.model();
+    model.applyInitialSolution();
+
+    // fill the cache of the current solution in a single sweep
+    model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+    auto equal = [](const Evaluation& a, const Evaluation& b) {
+        auto close = [](double x, double y)
+        { return std::abs(x - y) <= 1e-12*std::max(1.0, std::abs(y)); };
+
+        if (!close(a.value(), b.value()))
+            return false;
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+            if (!close(a.derivative(pvIdx), b.derivative(pvIdx)))
+                return false;
+        return true;
+    };
+
+    // the reference is computed by the element context without consulting the cache
+    ElementContext elemCtx(simulator);
+    unsigned numCompared = 0;
+    for (const auto& elem : elements(simulator.gridView())) {
+        elemCtx.updatePrimaryStencil(elem);
+
+        unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+            unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+            const auto* cachedIntQuants = model.cachedIntensiveQuantities(globalIdx, /*timeIdx=*/0);
+            if (!cachedIntQuants) {
+                std::cerr << "The intensive quantities of DOF " << globalIdx
+                          << " have not been cached\n";
+                return 1;
+            }
+
+            elemCtx.updateIntensiveQuantities(model.solution(/*timeIdx=*/0)[globalIdx],
+                                              dofIdx,
+                                              /*timeIdx=*/0);
+            const auto& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+            const auto& fs = intQuants.fluidState();
+            const auto& cachedFs = cachedIntQuants->fluidState();
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (!equal(cachedFs.pressure(phaseIdx), fs.pressure(phaseIdx)) ||
+                    !equal(cachedFs.saturation(phaseIdx), fs.saturation(phaseIdx)) ||
+                    !equal(cachedFs.density(phaseIdx), fs.density(phaseIdx)) ||
+                    !equal(cachedIntQuants->mobility(phaseIdx), intQuants.mobility(phaseIdx)))
+                {
+                    std::cerr << "The cached intensive quantities of DOF " << globalIdx
+                              << " differ from the ones of the element context for phase "
+                              << phaseIdx << "\n";
+                    return 1;
+                }
+            }
+            ++numCompared;
+        }
+    }
+
+    // make sure that the comparison was not trivial
+    if (numCompared == 0) {
+        std::cerr << "No degree of freedom has been compared\n";
+        return 1;
+    }
+
+    return 0;
+}
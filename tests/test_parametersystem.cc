@@ -0,0 +1,110 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This file tests that cached run-time parameters pick up values which are
+ *        specified after they were retrieved for the first time.
+ */
+#include "config.h"
+
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct ParamTest { using InheritsFrom = std::tuple<ParameterSystem>; };
+} // namespace TTag
+
+template<class TypeTag, class MyTypeTag>
+struct NumIterations { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct NumIterations<TypeTag, TTag::ParamTest> { static constexpr int value = 3; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+using TypeTag = Properties::TTag::ParamTest;
+
+static void registerParameters()
+{
+    EWOMS_REGISTER_PARAM(TypeTag, int, NumIterations, "The number of iterations");
+    EWOMS_END_PARAM_REGISTRATION(TypeTag);
+}
+
+// the parameter is always retrieved from the same call site
+static int numIterations()
+{ return EWOMS_GET_PARAM(TypeTag, int, NumIterations); }
+
+} // namespace Opm
+
+using TypeTag = Opm::TypeTag;
+using Opm::numIterations;
+
+int main()
+{
+    Opm::registerParameters();
+    Opm::Parameters::setCountReads<TypeTag>(true);
+
+    if (numIterations() != 3) {
+        std::cerr << "Wrong default value of the parameter\n";
+        return 1;
+    }
+
+    // specifying the parameter after it has been cached
+    const char *argv[] = { "test_parametersystem", "--num-iterations=7" };
+    Opm::Parameters::parseCommandLineOptions<TypeTag>(/*argc=*/2, argv, /*helpPreamble=*/"",
+                                                      Opm::Parameters::noPositionalParameters_);
+    for (int i = 0; i < 10; ++i) {
+        if (numIterations() != 7) {
+            std::cerr << "The cached parameter was not updated\n";
+            return 1;
+        }
+    }
+
+    std::ostringstream oss;
+    Opm::Parameters::printReadCounts<TypeTag>(oss);
+    if (oss.str().find("NumIterations: 11") == std::string::npos) {
+        std::cerr << "Wrong number of reads:\n" << oss.str();
+        return 1;
+    }
+
+    // after the parameters have been reset, they cannot be retrieved anymore
+    EWOMS_RESET_PARAMS_(TypeTag);
+    try {
+        numIterations();
+        std::cerr << "Retrieving a parameter after a reset did not fail\n";
+        return 1;
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    return 0;
+}
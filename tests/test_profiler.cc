@@ -0,0 +1,100 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Records nested regions on several threads and checks the statistics and the
+ *        trace which are written by the profiler.
+ */
+#include "config.h"
+
+#include <opm/models/utils/profiler.hh>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool contains(const std::string& s, const std::string& what)
+{
+    if (s.find(what) != std::string::npos)
+        return true;
+
+    std::cerr << "Expected '" << what << "' in:\n" << s << "\n";
+    return false;
+}
+
+int main()
+{
+    // regions are not recorded if the profiler is disabled
+    {
+        Opm::ProfilerRegion region("disabled");
+    }
+
+    Opm::Profiler::enable(/*traceEvents=*/true);
+    {
+        Opm::ProfilerRegion outerRegion("outer");
+        for (int i = 0; i < 3; ++i) {
+            Opm::ProfilerRegion innerRegion("inner", /*traced=*/false);
+            Opm::Profiler::addToCounter("items", 2);
+        }
+
+        // the worker threads attribute their regions to the path of this thread
+        const auto path = Opm::Profiler::currentPath();
+        std::vector<std::thread> workers;
+        for (int threadIdx = 0; threadIdx < 2; ++threadIdx)
+            workers.emplace_back([&path]() {
+                Opm::ProfilerRegion region("work", path);
+                Opm::Profiler::addToCounter("items", 1);
+            });
+        for (auto& worker : workers)
+            worker.join();
+    }
+    Opm::Profiler::disable();
+
+    std::ostringstream json;
+    Opm::Profiler::writeJson(json);
+    const std::string& summary = json.str();
+    if (summary.find("disabled") != std::string::npos) {
+        std::cerr << "A region was recorded while the profiler was disabled\n";
+        return 1;
+    }
+    if (!contains(summary, "\"path\": \"outer/inner\", \"name\": \"inner\", \"depth\": 1, \"calls\": 3")
+        || !contains(summary, "\"path\": \"outer/work\", \"name\": \"work\", \"depth\": 1, \"calls\": 2")
+        || !contains(summary, "\"path\": \"outer\", \"name\": \"outer\", \"depth\": 0, \"calls\": 1")
+        || !contains(summary, "{\"name\": \"items\", \"total\": 8"))
+        return 1;
+
+    // the fine grained "inner" regions are not part of the trace
+    std::ostringstream trace;
+    Opm::Profiler::writeChromeTrace(trace);
+    if (!contains(trace.str(), "{\"name\": \"outer\", \"ph\": \"X\""))
+        return 1;
+    if (trace.str().find("\"inner\"") != std::string::npos) {
+        std::cerr << "A region which should not be traced was traced\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the tables packed by RegionTableArena yield the same results as
+ *        the original tabulated functions.
+ */
+#include "config.h"
+
+#include <opm/models/utils/regiontablearena.hh>
+#include <opm/models/utils/tabulatedsegmenthint.hh>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using SourceTable = Opm::Tabulated1DFunction<double>;
+using Arena = Opm::RegionTableArena<double>;
+
+static bool checkTable(const SourceTable& sourceTable,
+                       const Arena::Table& table,
+                       double tolerance)
+{
+    if (table.numSamples() != sourceTable.numSamples()) {
+        std::cerr << "Wrong number of sampling points\n";
+        return false;
+    }
+
+    Opm::TabulatedSegmentHint hint;
+    double xMin = sourceTable.xMin();
+    double xMax = sourceTable.xMax();
+    for (int i = 0; i <= 1000; ++i) {
+        double x = xMin - 0.1*(xMax - xMin) + 1.2e-3*i*(xMax - xMin);
+
+        double expected = sourceTable.eval(x, /*extrapolate=*/true);
+        double value = table.eval(x, /*extrapolate=*/true);
+        double hintValue = hint.eval(table, x, /*extrapolate=*/true);
+        double maxError = tolerance*std::max(1.0, std::abs(expected));
+        if (std::abs(value - expected) > maxError || std::abs(hintValue - expected) > maxError) {
+            std::cerr << "Wrong value at x=" << x << ": " << value
+                      << " instead of " << expected << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::vector<double> x;
+    std::vector<double> y;
+
+    std::vector<SourceTable> smoothTables(3);
+    for (unsigned regionIdx = 0; regionIdx < smoothTables.size(); ++regionIdx) {
+        x.clear();
+        y.clear();
+        for (int i = 0; i < 20 + 10*static_cast<int>(regionIdx); ++i) {
+            x.push_back(0.05*i);
+            y.push_back(std::exp(-0.05*i*(regionIdx + 1)));
+        }
+        smoothTables[regionIdx].setXYContainers(x, y);
+    }
+
+    // tables which cannot be represented using single precision: values which are
+    // flushed to zero and sampling points which are merged by rounding
+    std::vector<SourceTable> difficultTables(2);
+    difficultTables[0].setXYContainers(std::vector<double>{0.0, 1.0, 2.0},
+                                       std::vector<double>{1e-50, 2e-50, 4e-50});
+    difficultTables[1].setXYContainers(std::vector<double>{1.0, 1.0 + 1e-12, 2.0},
+                                       std::vector<double>{0.0, 1.0, 2.0});
+
+    Arena arena({&smoothTables, &difficultTables});
+
+    // full precision
+    for (unsigned regionIdx = 0; regionIdx < smoothTables.size(); ++regionIdx) {
+        const auto& table = arena.table(/*groupIdx=*/0, regionIdx, /*replicaIdx=*/0);
+        if (table.storesFloat() || !checkTable(smoothTables[regionIdx], table, 1e-14))
+            return 1;
+    }
+    for (unsigned regionIdx = 0; regionIdx < difficultTables.size(); ++regionIdx) {
+        const auto& table = arena.table(/*groupIdx=*/1, regionIdx, /*replicaIdx=*/0);
+        if (!checkTable(difficultTables[regionIdx], table, 1e-14))
+            return 1;
+    }
+
+    // single precision where it is accurate enough, two replicas
+    arena.setStorage(/*useFloat=*/true, /*floatTolerance=*/1e-6, /*numReplicas=*/2);
+    for (unsigned replicaIdx = 0; replicaIdx < arena.numReplicas(); ++replicaIdx) {
+        for (unsigned regionIdx = 0; regionIdx < smoothTables.size(); ++regionIdx) {
+            const auto& table = arena.table(/*groupIdx=*/0, regionIdx, replicaIdx);
+            if (!table.storesFloat()) {
+                std::cerr << "Smooth table is not stored using single precision\n";
+                return 1;
+            }
+            if (!checkTable(smoothTables[regionIdx], table, 1e-6))
+                return 1;
+        }
+        for (unsigned regionIdx = 0; regionIdx < difficultTables.size(); ++regionIdx) {
+            const auto& table = arena.table(/*groupIdx=*/1, regionIdx, replicaIdx);
+            if (table.storesFloat()) {
+                std::cerr << "Inaccurate table is stored using single precision\n";
+                return 1;
+            }
+            if (!checkTable(difficultTables[regionIdx], table, 1e-14))
+                return 1;
+        }
+    }
+    if (&arena.table(0, 0, 0) == &arena.table(0, 0, 1)) {
+        std::cerr << "The replicas are not separate\n";
+        return 1;
+    }
+
+    // modified source tables must be re-packed after the arena was invalidated
+    smoothTables[1] = smoothTables[2];
+    arena.invalidate();
+    for (unsigned replicaIdx = 0; replicaIdx < arena.numReplicas(); ++replicaIdx)
+        if (!checkTable(smoothTables[2], arena.table(0, 1, replicaIdx), 1e-6))
+            return 1;
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that evaluating tabulated functions using a segment hint yields the
+ *        same results as Tabulated1DFunction::eval().
+ */
+#include "config.h"
+
+#include <opm/models/utils/tabulatedsegmenthint.hh>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static bool checkTable(const Opm::Tabulated1DFunction<double>& table)
+{
+    Opm::TabulatedSegmentHint hint;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> jumpDist(table.xMin() - 1.0, table.xMax() + 1.0);
+    std::normal_distribution<double> stepDist(0.0, 1e-2*(table.xMax() - table.xMin()));
+
+    // alternate between small steps, which are the common case, and large jumps
+    double x = table.xMin();
+    for (int i = 0; i < 10000; ++i) {
+        if (i % 10 == 0)
+            x = jumpDist(rng);
+        else
+            x += stepDist(rng);
+
+        double expected = table.eval(x, /*extrapolate=*/true);
+        double value = hint.eval(table, x, /*extrapolate=*/true);
+        if (std::abs(value - expected) > 1e-12*std::max(1.0, std::abs(expected))) {
+            std::cerr << "Wrong value at x=" << x << ": " << value
+                      << " instead of " << expected << "\n";
+            return false;
+        }
+    }
+
+    // the sampling points themselves
+    for (size_t sampleIdx = 0; sampleIdx < table.numSamples(); ++sampleIdx) {
+        double value = hint.eval(table, table.xAt(sampleIdx));
+        if (std::abs(value - table.valueAt(sampleIdx)) > 1e-12) {
+            std::cerr << "Wrong value at sampling point " << sampleIdx << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::vector<double> x;
+    std::vector<double> y;
+
+    // uniformly sampled table
+    for (int i = 0; i < 50; ++i) {
+        x.push_back(0.1*i);
+        y.push_back(std::sin(0.1*i));
+    }
+    Opm::Tabulated1DFunction<double> uniformTable;
+    uniformTable.setXYContainers(x, y);
+    if (!checkTable(uniformTable))
+        return 1;
+
+    // table with strongly varying distances between the sampling points
+    x.clear();
+    y.clear();
+    for (int i = 0; i < 50; ++i) {
+        x.push_back(std::pow(1.2, i) - 1.0);
+        y.push_back(std::sqrt(x.back()));
+    }
+    Opm::Tabulated1DFunction<double> nonUniformTable;
+    nonUniformTable.setXYContainers(x, y);
+    if (!checkTable(nonUniformTable))
+        return 1;
+
+    // a single segment
+    Opm::Tabulated1DFunction<double> twoPointTable;
+    twoPointTable.setXYContainers(std::vector<double>{1.0, 2.0}, std::vector<double>{3.0, 5.0});
+    if (!checkTable(twoPointTable))
+        return 1;
+
+    return 0;
+}
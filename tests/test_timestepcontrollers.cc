@@ -0,0 +1,200 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks the time step sizes which are suggested by the PID time step
+ *        controller for a given change of the solution.
+ */
+#include "config.h"
+
+#include <opm/models/discretization/common/timestepcontrollers.hh>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace Opm {
+// a minimal simulator which provides everything required by the time step controllers
+class MockSimulator
+{
+public:
+    using PrimaryVariables = std::array<double, 2>;
+    using SolutionVector = std::vector<PrimaryVariables>;
+
+    struct Comm
+    { double max(double value) const { return value; } };
+
+    struct GridView
+    { Comm comm() const { return Comm(); } };
+
+    struct NewtonMethod
+    {
+        double suggestTimeStepSize(double oldDt) const
+        { return oldDt*growthFactor; }
+
+        double growthFactor = 10.0;
+    };
+
+    struct Model
+    {
+        const SolutionVector& solution(unsigned timeIdx) const
+        { return solution_[timeIdx]; }
+
+        size_t numGridDof() const
+        { return solution_[0].size(); }
+
+        bool isLocalDof(unsigned) const
+        { return true; }
+
+        double primaryVarWeight(unsigned, unsigned pvIdx) const
+        { return pvIdx == 0 ? 1e-5 : 1.0; }
+
+        const NewtonMethod& newtonMethod() const
+        { return newtonMethod_; }
+
+        SolutionVector solution_[2];
+        NewtonMethod newtonMethod_;
+    };
+
+    const Model& model() const
+    { return model_; }
+
+    GridView gridView() const
+    { return GridView(); }
+
+    // set up a time step for which the weighted change of the solution is 'change'
+    void setChange(double change)
+    {
+        model_.solution_[1] = SolutionVector(3, PrimaryVariables{{1e7, 0.5}});
+        model_.solution_[0] = model_.solution_[1];
+        model_.solution_[0][1][1] += change;
+        // the change of the pressure is smaller after weighting
+        model_.solution_[0][2][0] += 0.5*change/1e-5;
+    }
+
+    Model model_;
+};
+} // namespace Opm
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct TimeStepControlTest { using InheritsFrom = std::tuple<NumericModel>; };
+} // namespace TTag
+
+template<class TypeTag>
+struct Simulator<TypeTag, TTag::TimeStepControlTest> { using type = Opm::MockSimulator; };
+
+template<class TypeTag>
+struct NumEq<TypeTag, TTag::TimeStepControlTest> { static constexpr int value = 2; };
+
+template<class TypeTag>
+struct TimeStepControlTolerance<TypeTag, TTag::TimeStepControlTest>
+{ using type = double; static constexpr type value = 0.1; };
+
+template<class TypeTag>
+struct TimeStepControlMaxGrowth<TypeTag, TTag::TimeStepControlTest>
+{ using type = double; static constexpr type value = 3.0; };
+
+template<class TypeTag>
+struct TimeStepControlRetryFactor<TypeTag, TTag::TimeStepControlTest>
+{ using type = double; static constexpr type value = 0.25; };
+
+} // namespace Opm::Properties
+
+using TypeTag = Opm::Properties::TTag::TimeStepControlTest;
+using Controller = Opm::PidTimeStepController<TypeTag>;
+
+static bool checkStepSize(const Controller& controller, double expectedDt)
+{
+    double dt = controller.suggestTimeStepSize(/*oldDt=*/100.0);
+    if (std::abs(dt - expectedDt) > 1e-10*expectedDt) {
+        std::cerr << "Wrong time step size " << dt << " instead of " << expectedDt << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    Controller::registerParameters();
+    EWOMS_END_PARAM_REGISTRATION(TypeTag);
+
+    Opm::MockSimulator simulator;
+
+    {
+        Controller controller(simulator);
+        if (controller.retryTimeStepSize(100.0) != 25.0) {
+            std::cerr << "Wrong size of the retried time step\n";
+            return 1;
+        }
+
+        // a change below the tolerance lets the step size grow, but only according to
+        // the integral term as long as there is no history
+        simulator.setChange(0.05);
+        controller.timeStepSucceeded();
+        if (!checkStepSize(controller, 100.0*std::pow(2.0, 0.175)))
+            return 1;
+
+        // a change above the tolerance reduces the step size proportionally
+        simulator.setChange(0.4);
+        controller.timeStepSucceeded();
+        if (!checkStepSize(controller, 25.0))
+            return 1;
+
+        // a tiny change lets the step size grow by at most the maximum growth factor
+        simulator.setChange(1e-8);
+        controller.timeStepSucceeded();
+        if (!checkStepSize(controller, 300.0))
+            return 1;
+
+        // the step size suggested by the Newton method is never exceeded
+        simulator.model_.newtonMethod_.growthFactor = 1.2;
+        if (!checkStepSize(controller, 120.0))
+            return 1;
+        simulator.model_.newtonMethod_.growthFactor = 10.0;
+    }
+
+    {
+        // once the history is available, a change which stays at the tolerance keeps
+        // the step size constant
+        Controller controller(simulator);
+        for (int i = 0; i < 3; ++i) {
+            simulator.setChange(0.1);
+            controller.timeStepSucceeded();
+        }
+        if (!checkStepSize(controller, 100.0))
+            return 1;
+
+        // a decreasing change lets the step size grow by more than the integral term
+        simulator.setChange(0.05);
+        controller.timeStepSucceeded();
+        double expectedFactor = std::pow(2.0, 0.075)*std::pow(2.0, 0.175)*std::pow(2.0, 0.01);
+        if (!checkStepSize(controller, 100.0*expectedFactor))
+            return 1;
+    }
+
+    return 0;
+}
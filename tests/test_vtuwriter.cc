@@ -0,0 +1,185 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Writes a structured grid using the native VTU writer and checks that the
+ *        appended data blocks are consistent with the offsets given in the header.
+ */
+#include "config.h"
+
+#include <opm/models/io/vtuwriter.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+using Grid = Dune::YaspGrid<2>;
+using GridView = Grid::LeafGridView;
+using Mapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+using VtuWriter = Opm::VtuWriter<GridView, Mapper, Mapper>;
+
+// returns the offsets of all data arrays of a VTU file and the position of the
+// appended data
+static std::vector<std::uint64_t> readOffsets(const std::string& content, size_t& appendedPos)
+{
+    std::vector<std::uint64_t> offsets;
+    const std::string key = "offset=\"";
+    size_t pos = 0;
+    while ((pos = content.find(key, pos)) != std::string::npos) {
+        pos += key.size();
+        offsets.push_back(std::stoull(content.substr(pos, content.find('"', pos) - pos)));
+    }
+
+    appendedPos = content.find("<AppendedData encoding=\"raw\">");
+    appendedPos = content.find('_', appendedPos) + 1;
+    return offsets;
+}
+
+static std::string readFile(const std::string& fileName)
+{
+    std::ifstream is(fileName.c_str(), std::ios::in | std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+}
+
+static bool checkFile(const std::string& fileName, size_t numArrays, bool compressed)
+{
+    const std::string& content = readFile(fileName);
+
+    size_t appendedPos;
+    const auto& offsets = readOffsets(content, appendedPos);
+    if (offsets.size() != numArrays) {
+        std::cerr << fileName << ": expected " << numArrays << " data arrays, found "
+                  << offsets.size() << "\n";
+        return false;
+    }
+
+    // walk over the appended blocks and make sure that each of them starts at the
+    // offset specified by the header
+    std::uint64_t curOffset = 0;
+    for (size_t arrayIdx = 0; arrayIdx < offsets.size(); ++arrayIdx) {
+        if (offsets[arrayIdx] != curOffset) {
+            std::cerr << fileName << ": data array " << arrayIdx << " starts at "
+                      << curOffset << " instead of " << offsets[arrayIdx] << "\n";
+            return false;
+        }
+
+        const char* block = content.data() + appendedPos + curOffset;
+        std::uint64_t blockSize;
+        if (compressed) {
+            std::uint64_t numBlocks;
+            std::memcpy(&numBlocks, block, sizeof(numBlocks));
+            blockSize = (3 + numBlocks)*sizeof(std::uint64_t);
+            for (std::uint64_t i = 0; i < numBlocks; ++i) {
+                std::uint64_t compressedSize;
+                std::memcpy(&compressedSize, block + (3 + i)*sizeof(std::uint64_t), sizeof(compressedSize));
+                blockSize += compressedSize;
+            }
+        }
+        else {
+            std::memcpy(&blockSize, block, sizeof(blockSize));
+            blockSize += sizeof(std::uint64_t);
+        }
+        curOffset += blockSize;
+    }
+
+    const std::string tail = "\n </AppendedData>";
+    if (content.compare(appendedPos + curOffset, tail.size(), tail) != 0) {
+        std::cerr << fileName << ": the appended data has an unexpected size\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double, 2> upperRight(1.0);
+    std::array<int, 2> cells = {{20, 10}};
+    Grid grid(upperRight, cells);
+    const auto& gridView = grid.leafGridView();
+
+    Mapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+    Mapper elementMapper(gridView, Dune::mcmgElementLayout());
+
+    Opm::BaseOutputWriter::ScalarBuffer cellData(elementMapper.size());
+    for (size_t i = 0; i < cellData.size(); ++i)
+        cellData[i] = static_cast<double>(i);
+
+    Opm::BaseOutputWriter::VectorBuffer vertexData(vertexMapper.size());
+    for (size_t i = 0; i < vertexData.size(); ++i) {
+        vertexData[i].resize(2);
+        vertexData[i][0] = static_cast<double>(i);
+        vertexData[i][1] = -static_cast<double>(i);
+    }
+
+    // two fields, the points and three arrays for the cells
+    const size_t numArrays = 2 + 1 + 3;
+
+    VtuWriter rawWriter(gridView, vertexMapper, elementMapper, /*compress=*/false);
+    rawWriter.addScalarCellData(cellData, "cellIdx");
+    rawWriter.addVectorVertexData(vertexData, "vertexIdx");
+    if (!checkFile(rawWriter.write("test_vtuwriter_raw"), numArrays, /*compressed=*/false))
+        return 1;
+
+    // the writer of a later time step which reuses the encoded grid must produce the
+    // same file
+    auto mesh = std::make_shared<Opm::VtuMesh>();
+    VtuWriter firstWriter(gridView, vertexMapper, elementMapper, /*compress=*/false, mesh);
+    firstWriter.addScalarCellData(cellData, "cellIdx");
+    firstWriter.addVectorVertexData(vertexData, "vertexIdx");
+    firstWriter.write("test_vtuwriter_first");
+    if (!mesh->valid) {
+        std::cerr << "The grid was not stored by the first writer\n";
+        return 1;
+    }
+
+    VtuWriter secondWriter(gridView, vertexMapper, elementMapper, /*compress=*/false, mesh);
+    secondWriter.addScalarCellData(cellData, "cellIdx");
+    secondWriter.addVectorVertexData(vertexData, "vertexIdx");
+    if (readFile(secondWriter.write("test_vtuwriter_second")) != readFile("test_vtuwriter_raw.vtu")) {
+        std::cerr << "Reusing the encoded grid changed the written file\n";
+        return 1;
+    }
+
+#if HAVE_ZLIB
+    VtuWriter compressedWriter(gridView, vertexMapper, elementMapper, /*compress=*/true);
+    compressedWriter.addScalarCellData(cellData, "cellIdx");
+    compressedWriter.addVectorVertexData(vertexData, "vertexIdx");
+    if (!checkFile(compressedWriter.write("test_vtuwriter_compressed"), numArrays, /*compressed=*/true))
+        return 1;
+#endif
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Writes two time steps into an XDMF container and checks that the grid is
+ *        only written once.
+ */
+#include "config.h"
+
+#include <opm/models/io/xdmfwriter.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using Grid = Dune::YaspGrid<2>;
+using GridView = Grid::LeafGridView;
+using Mapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+using Container = Opm::XdmfContainer<GridView>;
+using XdmfWriter = Opm::XdmfWriter<GridView, Mapper, Mapper>;
+
+// returns the value of the first "Seek" attribute of the geometry of a time step
+static std::string geometrySeek(const std::string& stepXml)
+{
+    size_t pos = stepXml.find("<Geometry");
+    pos = stepXml.find("Seek=\"", pos) + 6;
+    return stepXml.substr(pos, stepXml.find('"', pos) - pos);
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double, 2> upperRight(1.0);
+    std::array<int, 2> cells = {{20, 10}};
+    Grid grid(upperRight, cells);
+    const auto& gridView = grid.leafGridView();
+
+    Mapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+    Mapper elementMapper(gridView, Dune::mcmgElementLayout());
+
+    Opm::BaseOutputWriter::ScalarBuffer cellData(elementMapper.size(), 1.0);
+
+    Container container(gridView, "test_xdmfwriter.bin");
+
+    XdmfWriter firstWriter(gridView, vertexMapper, elementMapper, container);
+    firstWriter.addScalarCellData(cellData, "cellData");
+    const std::string& firstXml = firstWriter.write(/*time=*/0.0);
+
+    XdmfWriter secondWriter(gridView, vertexMapper, elementMapper, container);
+    secondWriter.addScalarCellData(cellData, "cellData");
+    const std::string& secondXml = secondWriter.write(/*time=*/1.0);
+
+    // the points, the topology of the quadrilaterals (cell type plus four corners)
+    // and the field of the first time step, followed by the field of the second one
+    std::uint64_t numVertices = vertexMapper.size();
+    std::uint64_t numCells = elementMapper.size();
+    std::uint64_t expectedSize =
+        numVertices*3*sizeof(float)
+        + numCells*5*sizeof(std::int32_t)
+        + 2*numCells*sizeof(float);
+    if (container.size() != expectedSize) {
+        std::cerr << "The size of the container is " << container.size()
+                  << " bytes instead of " << expectedSize << "\n";
+        return 1;
+    }
+
+    std::ifstream is("test_xdmfwriter.bin", std::ios::in | std::ios::binary | std::ios::ate);
+    if (static_cast<std::uint64_t>(is.tellg()) != expectedSize) {
+        std::cerr << "The container file has an unexpected size\n";
+        return 1;
+    }
+
+    if (geometrySeek(firstXml) != geometrySeek(secondXml)) {
+        std::cerr << "The grid was not reused by the second time step\n";
+        return 1;
+    }
+
+    return 0;
+}